@@ -0,0 +1,63 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ACTIVATION_BATCH_H
+#define ACTIVATION_BATCH_H
+
+#include <chrono>
+#include <vector>
+
+#include "AssociativeMemory/memory_network.hpp"
+
+/**
+ * A set of unit activations (unit index, level, duration), collected off
+ * the network and handed to it in one go.
+ *
+ * The network has no batch entry point: apply() is the single place where
+ * a batch reaches it, and issues the activations back to back, with
+ * nothing (no name lookup, no allocation) in between. This is not atomic:
+ * the network thread may still step between two of them, so a batch can
+ * be spread over two consecutive steps.
+ */
+class ActivationBatch {
+
+    struct Activation {
+        size_t unit;
+        float level;
+        std::chrono::microseconds duration;
+    };
+
+    std::vector<Activation> activations;
+
+public:
+    void reserve(size_t size) {activations.reserve(size);}
+
+    void add(size_t unit, float level, std::chrono::microseconds duration) {
+        activations.push_back({unit, level, duration});
+    }
+
+    size_t size() const {return activations.size();}
+    bool empty() const {return activations.empty();}
+
+    void clear() {activations.clear();}
+
+    /** Activates all the units of the batch, and empties it
+     */
+    void apply(MemoryNetwork& memory);
+};
+
+#endif // ACTIVATION_BATCH_H
@@ -0,0 +1,82 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+
+#include "activation_history.h"
+
+using namespace std;
+using namespace std::chrono;
+
+ActivationHistory::ActivationHistory(size_t length, int sampling_rate) :
+    length(length),
+    sampling_period(duration_cast<microseconds>(seconds(1)) / sampling_rate),
+    units(0),
+    count(0),
+    last_sample(0)
+{
+}
+
+void ActivationHistory::reserve(size_t units) {
+    lock_guard<mutex> lock(samples_mutex);
+    samples.reserve(units * length);
+}
+
+void ActivationHistory::record(microseconds time_from_start, const MemoryVector& levels) {
+
+    if (time_from_start - last_sample <= sampling_period) return;
+    last_sample = time_from_start;
+
+    lock_guard<mutex> lock(samples_mutex);
+
+    // new units: their older samples are 0
+    if (units < (size_t) levels.size()) {
+        units = levels.size();
+        samples.resize(units * length, 0.0f);
+    }
+
+    size_t slot = count % length;
+    for (size_t i = 0; i < (size_t) levels.size(); i++) {
+        samples[i * length + slot] = levels[i];
+    }
+
+    count++;
+}
+
+uint64_t ActivationHistory::getCount() const {
+    lock_guard<mutex> lock(samples_mutex);
+    return count;
+}
+
+uint64_t ActivationHistory::read(size_t unit, uint64_t since, vector<float>& values) const {
+
+    lock_guard<mutex> lock(samples_mutex);
+
+    values.clear();
+
+    if (unit >= units) return count;
+
+    const float* ring = &samples[unit * length];
+
+    uint64_t first = max(since, count > length ? count - length : 0);
+
+    for (uint64_t i = first; i < count; i++) {
+        values.push_back(ring[i % length]);
+    }
+
+    return count;
+}
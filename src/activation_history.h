@@ -0,0 +1,81 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ACTIVATION_HISTORY_H
+#define ACTIVATION_HISTORY_H
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "AssociativeMemory/memory_network.hpp"
+
+/**
+ * Recent activation levels of every unit, sampled at a fixed rate.
+ *
+ * Samples are recorded by the network thread (through the activation
+ * logger) and read by the rendering thread, hence the mutex.
+ *
+ * All the units share the same ring: sample number i is stored in slot
+ * i % length of every unit. Readers keep the number of the last sample
+ * they read, and only fetch the samples appended since.
+ *
+ * The rings of all the units are stored in one block: reserve() avoids its
+ * reallocation (under the lock of the network thread) when units arrive.
+ */
+class ActivationHistory {
+
+    mutable std::mutex samples_mutex;
+
+    size_t length;
+    std::chrono::microseconds sampling_period;
+
+    // per unit ring buffers, one after the other
+    std::vector<float> samples;
+    size_t units;
+
+    // total number of samples recorded
+    uint64_t count;
+
+    std::chrono::microseconds last_sample;
+
+public:
+    ActivationHistory(size_t length, int sampling_rate);
+
+    /** Activation logger, called by the network at every step
+     */
+    void record(std::chrono::microseconds time_from_start, const MemoryVector& levels);
+
+    size_t getLength() const {return length;}
+
+    /** Allocates the rings of 'units' units up front
+     */
+    void reserve(size_t units);
+
+    uint64_t getCount() const;
+
+    /**
+     * Copies the samples of a unit recorded since sample number 'since' (at
+     * most the last 'length' ones), in chronological order. Returns the
+     * number of samples recorded so far: the last copied sample is the one
+     * just before.
+     */
+    uint64_t read(size_t unit, uint64_t since, std::vector<float>& values) const;
+};
+
+#endif // ACTIVATION_HISTORY_H
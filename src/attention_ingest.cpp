@@ -0,0 +1,107 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <chrono>
+
+#include "attention_ingest.h"
+
+using namespace std;
+
+static const chrono::microseconds ACTIVATION_DURATION = chrono::milliseconds(60);
+
+AttentionIngest::AttentionIngest(MemoryNetwork& memory) :
+    messages(0),
+    memory(memory),
+    window(0.01),
+    received_messages(0),
+    latency(nullptr)
+{
+}
+
+void AttentionIngest::setCapacity(size_t capacity) {
+    targets.setCapacity(capacity);
+    batch.reserve(capacity);
+}
+
+void AttentionIngest::setWindow(double window) {
+    this->window = window;
+}
+
+void AttentionIngest::setCoalescing(coalescing_mode mode) {
+    targets.setMode(mode);
+}
+
+void AttentionIngest::reserveUnits(size_t units) {
+    this->units.reserve(units);
+    targets.reserveUnits(units);
+}
+
+void AttentionIngest::setLatencyTracker(LatencyTracker* latency) {
+    this->latency = latency;
+}
+
+void AttentionIngest::received(uint64_t stamp_us) {
+
+    received_messages++;
+
+    if (!latency) return;
+
+    receipts.push_back(LatencyTracker::Clock::now());
+
+    if (stamp_us) {
+        uint64_t now_us = chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count();
+        // clocks of different hosts may not be perfectly synchronized
+        transport_us.push_back(now_us > stamp_us ? now_us - stamp_us : 0);
+    }
+}
+
+void AttentionIngest::drain() {
+
+    if (targets.empty()) return;
+
+    targets.drain([this](size_t unit, float intensity) {
+        batch.add(unit, intensity, ACTIVATION_DURATION);
+    });
+
+    batch.apply(memory);
+
+    if (latency) {
+        latency->activated(receipts, transport_us);
+        receipts.clear();
+        transport_us.clear();
+    }
+
+    {
+        lock_guard<std::mutex> lock(mutex);
+        messages++;
+    }
+    arrived.notify_all();
+}
+
+uint64_t AttentionIngest::messageCount() {
+    lock_guard<std::mutex> lock(mutex);
+    return messages;
+}
+
+uint64_t AttentionIngest::waitForMessages(uint64_t seen, double timeout) {
+
+    unique_lock<std::mutex> lock(mutex);
+
+    arrived.wait_for(lock, chrono::duration<double>(timeout), [this, seen]{return messages > seen;});
+
+    return messages;
+}
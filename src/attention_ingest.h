@@ -0,0 +1,142 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ATTENTION_INGEST_H
+#define ATTENTION_INGEST_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "AssociativeMemory/memory_network.hpp"
+
+#include "activation_batch.h"
+#include "attention_queue.h"
+#include "latency.h"
+#include "unit_index.h"
+
+/**
+ * Activation path shared by the sources of attention targets (ROS topic,
+ * stream).
+ *
+ * A source receives messages in its own thread, and pushes their targets
+ * (see target()) in an AttentionQueue, which merges the targets of a same
+ * unit. Every 'window', from the same thread, the source drains the queue
+ * (see drain()): all the targets of the window are handed to the network as
+ * one ActivationBatch, so that the targets of a message are never split
+ * across two windows, and units are activated at most once per window.
+ */
+class AttentionIngest {
+
+    std::mutex mutex;
+    std::condition_variable arrived;
+    // number of drains that activated units
+    uint64_t messages;
+
+protected:
+    MemoryNetwork& memory;
+
+    AttentionQueue targets;
+    UnitIndex units;
+    ActivationBatch batch;
+
+    double window;
+
+    std::atomic<uint64_t> received_messages;
+
+    LatencyTracker* latency;
+    // receipts and transport latencies of the messages of the window
+    std::vector<LatencyTracker::Clock::time_point> receipts;
+    std::vector<uint64_t> transport_us;
+
+    /** To be called once per message, before pushing its targets. 'stamp_us'
+     * is the time the message was sent, in microseconds since the epoch, or
+     * 0 if unknown.
+     */
+    void received(uint64_t stamp_us = 0);
+
+    void target(const std::string& frame_id, float intensity) {
+        targets.push(units.intern(memory, frame_id), intensity);
+    }
+
+    void target(const char* frame_id, size_t length, float intensity) {
+        targets.push(units.intern(memory, frame_id, length), intensity);
+    }
+
+    /** Activates the queued targets. Must be called from the thread that
+     * pushes them.
+     */
+    void drain();
+
+public:
+    AttentionIngest(MemoryNetwork& memory);
+    virtual ~AttentionIngest() {}
+
+    /** Capacity of the attention queue (distinct units per window). Must be
+     * called before start().
+     */
+    void setCapacity(size_t capacity);
+
+    /** Period at which the queued targets are applied, in seconds. Must be
+     * called before start().
+     */
+    void setWindow(double window);
+
+    void setCoalescing(coalescing_mode mode);
+
+    /** Sizes the tables indexed by unit for 'units' units. Must be called
+     * before start().
+     */
+    void reserveUnits(size_t units);
+
+    /** Reports the latencies of the messages to 'latency'. Must be called
+     * before start().
+     */
+    void setLatencyTracker(LatencyTracker* latency);
+
+    uint64_t receivedMessages() const {return received_messages;}
+
+    /** Messages lost before reaching the ingestion (eg, overflow of the
+     * transport queues), as far as the source can tell
+     */
+    virtual uint64_t lostMessages() const {return 0;}
+    const AttentionQueue& attentionQueue() const {return targets;}
+
+    /** Acquires the source of the messages, before the network is started.
+     * Throws a MemoryViewException if the source is not available.
+     */
+    virtual void openSource() {}
+
+    /** Starts receiving messages, in a thread of the source
+     */
+    virtual void start() = 0;
+    virtual void stop() = 0;
+
+    /** Number of times units were activated so far
+     */
+    uint64_t messageCount();
+
+    /** Blocks until units are activated more than 'seen' times, or for at
+     * most 'timeout' seconds. Returns messageCount().
+     */
+    uint64_t waitForMessages(uint64_t seen, double timeout);
+};
+
+#endif // ATTENTION_INGEST_H
@@ -0,0 +1,65 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+
+#include "attention_queue.h"
+
+using namespace std;
+
+AttentionQueue::AttentionQueue(size_t capacity, coalescing_mode mode) :
+    targets(capacity),
+    count(0),
+    mode(mode),
+    received(0),
+    coalesced(0),
+    dropped(0)
+{
+}
+
+void AttentionQueue::setCapacity(size_t capacity) {
+    targets.resize(max(capacity, count));
+}
+
+bool AttentionQueue::push(size_t unit, float intensity) {
+
+    received++;
+
+    if (unit >= pending.size()) pending.resize(unit + 1, -1);
+
+    if (pending[unit] >= 0) {
+        Target& target = targets[pending[unit]];
+
+        if (mode == COALESCE_SUM) target.intensity += intensity;
+        else target.intensity = max(target.intensity, intensity);
+
+        coalesced++;
+        return true;
+    }
+
+    if (count == targets.size()) {
+        dropped++;
+        return false;
+    }
+
+    targets[count].unit = unit;
+    targets[count].intensity = intensity;
+    pending[unit] = count;
+    count++;
+
+    return true;
+}
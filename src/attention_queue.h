@@ -0,0 +1,94 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ATTENTION_QUEUE_H
+#define ATTENTION_QUEUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+enum coalescing_mode {COALESCE_MAX, COALESCE_SUM};
+
+/**
+ * Bounded buffer of attention targets, between the reception of the
+ * messages and the activation of the units.
+ *
+ * Targets are identified by the index of their unit (see UnitIndex).
+ * Targets for a unit already in the buffer are merged with it (keeping the
+ * maximum, or the sum, of the intensities), so the buffer holds at most one
+ * entry per unit and is drained at a fixed period. Targets are only dropped
+ * if more distinct units than the capacity of the buffer are targeted
+ * within a period.
+ *
+ * Not thread-safe, except for the counters, which can be read from any
+ * thread.
+ */
+class AttentionQueue {
+
+    struct Target {
+        size_t unit;
+        float intensity;
+    };
+
+    std::vector<Target> targets;
+    size_t count;
+
+    // unit -> index of its entry, or -1
+    std::vector<int> pending;
+
+    coalescing_mode mode;
+
+    std::atomic<uint64_t> received;
+    std::atomic<uint64_t> coalesced;
+    std::atomic<uint64_t> dropped;
+
+public:
+    AttentionQueue(size_t capacity = 256, coalescing_mode mode = COALESCE_MAX);
+
+    void setCapacity(size_t capacity);
+    void setMode(coalescing_mode mode) {this->mode = mode;}
+
+    /** Queues a target. Returns false if it was dropped.
+     */
+    bool push(size_t unit, float intensity);
+
+    /** Sizes the unit -> entry table for 'units' units
+     */
+    void reserveUnits(size_t units) {
+        if (pending.size() < units) pending.resize(units, -1);
+    }
+
+    bool empty() const {return count == 0;}
+
+    /** Calls f(unit, intensity) for each entry, and empties the buffer
+     */
+    template<typename F>
+    void drain(F f) {
+        for (size_t i = 0; i < count; i++) {
+            f(targets[i].unit, targets[i].intensity);
+            pending[targets[i].unit] = -1;
+        }
+        count = 0;
+    }
+
+    uint64_t receivedCount() const {return received;}
+    uint64_t coalescedCount() const {return coalesced;}
+    uint64_t droppedCount() const {return dropped;}
+};
+
+#endif // ATTENTION_QUEUE_H
@@ -0,0 +1,57 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+
+#include "colour_lut.h"
+
+using namespace std;
+
+// values are mapped by chunks, the indices of a chunk staying on the stack
+static const size_t CHUNK_SIZE = 256;
+
+ColourLUT::ColourLUT(const vec4f& negative, const vec4f& zero, const vec4f& positive) {
+    build(negative, zero, positive);
+}
+
+void ColourLUT::build(const vec4f& negative, const vec4f& zero, const vec4f& positive) {
+
+    for (int i = 0; i < SIZE; i++) {
+        float value = i / 127.5f - 1.0f;
+
+        if (value > 0) table[i] = zero + (positive - zero) * value;
+        else table[i] = zero + (negative - zero) * -value;
+    }
+}
+
+void ColourLUT::map(const float* values, size_t count, vec4f* colours) const {
+
+    int indices[CHUNK_SIZE];
+
+    for (size_t first = 0; first < count; first += CHUNK_SIZE) {
+
+        size_t n = min(CHUNK_SIZE, count - first);
+
+        for (size_t i = 0; i < n; i++) {
+            indices[i] = index(values[first + i]);
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            colours[first + i] = table[indices[i]];
+        }
+    }
+}
@@ -0,0 +1,64 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COLOUR_LUT_H
+#define COLOUR_LUT_H
+
+#include <cstddef>
+
+#include "core/vectors.h"
+
+/**
+ * Colour map of values in [-1, 1] (activations, weights), precomputed in a
+ * 256-entry table: 'negative' at -1, 'zero' at 0 and 'positive' at 1,
+ * linearly interpolated in between. Values outside the range are clamped,
+ * NaN is mapped to 'zero'.
+ *
+ * map() converts whole arrays at once: indices are computed in a first,
+ * branch-free loop (which the compiler vectorizes), then looked up.
+ */
+class ColourLUT {
+
+public:
+    static const int SIZE = 256;
+
+private:
+    vec4f table[SIZE];
+
+    static int index(float value) {
+        float x = value == value ? (value + 1.0f) * 127.5f + 0.5f : 128.0f;
+        x = x > 0.0f ? x : 0.0f;
+        x = x < SIZE - 1 ? x : SIZE - 1;
+        return (int) x;
+    }
+
+public:
+    ColourLUT(const vec4f& negative, const vec4f& zero, const vec4f& positive);
+
+    void build(const vec4f& negative, const vec4f& zero, const vec4f& positive);
+
+    const vec4f& operator()(float value) const {return table[index(value)];}
+
+    /** The SIZE entries of the table (entry i is the colour of
+     * i / 127.5 - 1), eg to upload it as a texture
+     */
+    const vec4f* data() const {return table;}
+
+    void map(const float* values, size_t count, vec4f* colours) const;
+};
+
+#endif // COLOUR_LUT_H
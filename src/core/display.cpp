@@ -271,3 +271,27 @@ vec3f SDLAppDisplay::unproject(vec2f pos) {
 
     return vec3f((float) posX, (float) posY, (float) posZ);
 }
+
+bool SDLAppDisplay::unprojectOnPlane(vec2f pos, vec2f& planepos, float z) {
+    GLint viewport[4];
+    GLdouble modelview[16];
+    GLdouble projection[16];
+    GLdouble nearX, nearY, nearZ, farX, farY, farZ;
+
+    glGetDoublev( GL_MODELVIEW_MATRIX, modelview );
+    glGetDoublev( GL_PROJECTION_MATRIX, projection );
+    glGetIntegerv( GL_VIEWPORT, viewport );
+
+    GLdouble winY = (float)viewport[3] - pos.y;
+
+    gluUnProject( pos.x, winY, 0.0, modelview, projection, viewport, &nearX, &nearY, &nearZ);
+    gluUnProject( pos.x, winY, 1.0, modelview, projection, viewport, &farX, &farY, &farZ);
+
+    if(fabs(farZ - nearZ) < 1e-9) return false;
+
+    GLdouble t = (z - nearZ) / (farZ - nearZ);
+
+    planepos = vec2f((float) (nearX + (farX - nearX) * t), (float) (nearY + (farY - nearY) * t));
+
+    return true;
+}
@@ -102,6 +102,11 @@ public:
     vec3f project(vec3f pos);
     vec3f unproject(vec2f pos);
 
+    // intersects the ray under a screen position with the plane z = 'z',
+    // using the current matrices. Returns false if the ray is parallel to
+    // the plane.
+    bool unprojectOnPlane(vec2f pos, vec2f& planepos, float z = 0.0f);
+
     void checkGLErrors();
 };
 
@@ -29,12 +29,97 @@
 
 FXFontManager fontmanager;
 
+// FXFontFace
+
+FXFontFace::FXFontFace(FTFont* ft, const std::string& file, int size)
+    : ft(ft), file(file), size(size) {
+
+    ascender  = ft->Ascender();
+    descender = ft->Descender();
+
+    for(int i=0; i<128; i++) glyphs[i].measured = false;
+}
+
+FXFontFace::~FXFontFace() {
+    delete ft;
+}
+
+const FXFontFace::Glyph& FXFontFace::glyph(int c) {
+
+    Glyph& g = glyphs[c];
+
+    if(!g.measured) {
+        char str[2] = { (char) c, 0 };
+
+        FTBBox bb = ft->BBox(str);
+
+        g.advance  = ft->Advance(str);
+        g.left     = bb.Lower().X();
+        g.right    = bb.Upper().X();
+        g.measured = true;
+    }
+
+    return g;
+}
+
+float FXFontFace::kern(int previous, int next) {
+
+    int key = previous << 7 | next;
+
+    std::unordered_map<int, float>::iterator it = kerning.find(key);
+    if(it != kerning.end()) return it->second;
+
+    char str[3] = { (char) previous, (char) next, 0 };
+
+    float k = ft->Advance(str) - glyph(previous).advance - glyph(next).advance;
+
+    kerning[key] = k;
+
+    return k;
+}
+
+float FXFontFace::getWidth(const std::string& text) {
+
+    // multi-byte (UTF-8) characters are not cached
+    for(size_t i=0; i<text.size(); i++) {
+        if(text[i] & 0x80) {
+            FTBBox bb = ft->BBox(text.c_str());
+            return bb.Upper().X() - bb.Lower().X();
+        }
+    }
+
+    float pen = 0.0f;
+    float lower = 0.0f, upper = 0.0f;
+    bool empty = true;
+
+    for(size_t i=0; i<text.size(); i++) {
+        int c = text[i];
+
+        if(i>0) pen += kern(text[i-1], c);
+
+        const Glyph& g = glyph(c);
+
+        // blank glyphs (spaces) do not extend the bounding box
+        if(g.right > g.left) {
+            if(empty || pen + g.left  < lower) lower = pen + g.left;
+            if(empty || pen + g.right > upper) upper = pen + g.right;
+            empty = false;
+        }
+
+        pen += g.advance;
+    }
+
+    return upper - lower;
+}
+
+// FXFont
+
 FXFont::FXFont() {
-    ft = 0;
+    face = 0;
 }
 
-FXFont::FXFont(FTFont* ft) {
-    this->ft = ft;
+FXFont::FXFont(FXFontFace* face) {
+    this->face = face;
     init();
 }
 
@@ -49,7 +134,7 @@ void FXFont::init() {
 }
 
 FTFont* FXFont::getFTFont() {
-    return ft;
+    return face->ft;
 }
 
 void FXFont::roundCoordinates(bool round) {
@@ -77,23 +162,23 @@ void FXFont::dropShadow(bool shadow) {
 }
 
 int FXFont::setFontSize(int pt) {
-    return ft->FaceSize(pt);
+    if(pt == face->size) return true;
+
+    face = fontmanager.face(face->file, pt);
+
+    return true;
 }
 
 int FXFont::getFontSize() {
-    return ft->FaceSize();
+    return face->size;
 }
 
 float FXFont::getHeight() {
-    return ft->Ascender() + ft->Descender();
+    return face->ascender + face->descender;
 }
 
-float FXFont::getWidth(std::string text) {
-    FTBBox bb = ft->BBox(text.c_str());
-
-    float width = (bb.Upper().X() - bb.Lower().X());
-
-    return width;
+float FXFont::getWidth(const std::string& text) {
+    return face->getWidth(text);
 }
 
 void FXFont::render(float x, float y, const std::string& text) {
@@ -107,7 +192,7 @@ void FXFont::render(float x, float y, const std::string& text) {
     glPushMatrix();
         glTranslatef(x,y,0.0f);
         glScalef(1.0, -1.0, 1.0f);
-        ft->Render(text.c_str());
+        face->ft->Render(text.c_str());
     glPopMatrix();
 }
 
@@ -152,9 +237,13 @@ void FXFontManager::setDir(std::string font_dir) {
     this->font_dir = font_dir;
 }
 
+std::string FXFontManager::getDir() {
+    return font_dir;
+}
+
 void FXFontManager::purge() {
 
-    for(std::map<std::string, FTFont*>::iterator it= fonts.begin(); it!=fonts.end();it++) {
+    for(std::map<std::string, FXFontFace*>::iterator it= fonts.begin(); it!=fonts.end();it++) {
         delete it->second;
     }
 
@@ -163,25 +252,30 @@ void FXFontManager::purge() {
 
 FXFont FXFontManager::grab(std::string font_file, int size) {
 
-    char buf[256];
-
     if(font_dir.size()>0 && font_file[0] != '/') {
         font_file = font_dir + font_file;
     }
 
-    sprintf(buf, "%s:%i", font_file.c_str(), size);
+    return FXFont(face(font_file, size));
+}
+
+FXFontFace* FXFontManager::face(const std::string& font_file, int size) {
+
+    char buf[256];
+
+    snprintf(buf, 256, "%s:%i", font_file.c_str(), size);
 
     std::string font_key = std::string(buf);
 
-    FTFont* ft = fonts[font_key];
+    FXFontFace* face = fonts[font_key];
 
-    if(ft==0) {
-        ft = create(font_file, size);
+    if(face==0) {
+        face = new FXFontFace(create(font_file, size), font_file, size);
 
-        fonts[font_key] = ft;
+        fonts[font_key] = face;
     }
 
-    return FXFont(ft);
+    return face;
 }
 
 FTFont* FXFontManager::create(std::string font_file, int size) {
@@ -36,6 +36,7 @@
 
 #include <string>
 #include <map>
+#include <unordered_map>
 
 #include <FTGL/ftgl.h>
 
@@ -44,9 +45,40 @@ public:
     FXFontException(std::string& font_file) : ResourceException(font_file) {}
 };
 
-class FXFont {
+// A font file at a given size, with its metrics. Widths of ASCII strings
+// are computed from cached glyph advances and kerning, instead of asking
+// FTGL for a bounding box.
+class FXFontFace {
+
+    struct Glyph {
+        float advance;
+        float left, right; // horizontal extent of the glyph
+        bool measured;
+    };
+
+    Glyph glyphs[128];
+
+    // (previous << 7 | next) -> kerning adjustment
+    std::unordered_map<int, float> kerning;
 
+    const Glyph& glyph(int c);
+    float kern(int previous, int next);
+public:
     FTFont* ft;
+    std::string file;
+    int size;
+
+    float ascender, descender;
+
+    FXFontFace(FTFont* ft, const std::string& file, int size);
+    ~FXFontFace();
+
+    float getWidth(const std::string& text);
+};
+
+class FXFont {
+
+    FXFontFace* face;
 
     bool shadow;
     bool round;
@@ -60,20 +92,22 @@ class FXFont {
     void init();
 public:
     FXFont();
-    FXFont(FTFont* ft);
+    FXFont(FXFontFace* face);
 
     FTFont* getFTFont();
 
     void print(float x, float y, const char *str, ...);
     void draw(float x, float y, const std::string& text);
 
-    float getWidth(std::string text);
+    float getWidth(const std::string& text);
 
     void alignTop(bool top);
     void alignRight(bool right);
 
     void roundCoordinates(bool round);
 
+    // switches to the face of that size (each size is a separate face,
+    // shared with the other FXFonts of that size)
     int setFontSize(int pt);
     int getFontSize();
 
@@ -88,11 +122,15 @@ class FXFontManager {
 
     std::string font_dir;
 
-    std::map<std::string, FTFont*> fonts;
+    std::map<std::string, FXFontFace*> fonts;
 
     FTFont* create(std::string font_file, int size);
 public:
+    // same as grab, but 'font_file' is not relative to the font directory
+    FXFontFace* face(const std::string& font_file, int size);
+
     void setDir(std::string font_dir);
+    std::string getDir();
     void purge();
     FXFont grab(std::string font_file, int size);
 };
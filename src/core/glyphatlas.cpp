@@ -0,0 +1,322 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "glyphatlas.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+// GlyphAtlas
+
+GlyphAtlas::GlyphAtlas() :
+    textureid(0),
+    pixel_size(0),
+    ascender(0.0f),
+    descender(0.0f)
+{
+}
+
+GlyphAtlas::~GlyphAtlas() {
+    if(textureid!=0) glDeleteTextures(1, &textureid);
+}
+
+int GlyphAtlas::glyphIndex(unsigned char c) const {
+    // anything we did not rasterize is rendered as '?'
+    if(c < FIRST_GLYPH || c > LAST_GLYPH) c = '?';
+    return c - FIRST_GLYPH;
+}
+
+void GlyphAtlas::load(std::string font_file, int pixel_size) {
+
+    this->pixel_size = pixel_size;
+
+    FT_Library library;
+    FT_Face face;
+
+    if(FT_Init_FreeType(&library)) throw GlyphAtlasException(font_file);
+
+    if(FT_New_Face(library, font_file.c_str(), 0, &face) ||
+       FT_Set_Pixel_Sizes(face, 0, pixel_size)) {
+        FT_Done_FreeType(library);
+        throw GlyphAtlasException(font_file);
+    }
+
+    debugLog("creating glyph atlas from %s (%dpx)\n", font_file.c_str(), pixel_size);
+
+    // FTGL's Descender() is negative, keep the same convention
+    ascender  = face->size->metrics.ascender  / 64.0f;
+    descender = face->size->metrics.descender / 64.0f;
+
+    //rasterize every glyph, and shelf-pack them as we go
+    const int padding = 1;
+    int atlas_w = 256;
+    int pen_x = padding, pen_y = padding, shelf_h = 0;
+
+    int glyph_x[GLYPH_COUNT], glyph_y[GLYPH_COUNT];
+    std::vector<unsigned char> bitmaps[GLYPH_COUNT];
+
+    for(int i = 0; i < GLYPH_COUNT; i++) {
+
+        Glyph& g = glyphs[i];
+        g = Glyph();
+
+        if(FT_Load_Char(face, FIRST_GLYPH + i, FT_LOAD_RENDER)) continue;
+
+        FT_GlyphSlot slot = face->glyph;
+        FT_Bitmap& bitmap = slot->bitmap;
+
+        g.advance = slot->advance.x / 64.0f;
+        g.left    = slot->bitmap_left;
+        g.top     = slot->bitmap_top;
+        g.w       = bitmap.width;
+        g.h       = bitmap.rows;
+
+        bitmaps[i].resize(bitmap.width * bitmap.rows);
+        for(unsigned int row = 0; row < bitmap.rows; row++) {
+            memcpy(&bitmaps[i][row * bitmap.width],
+                   bitmap.buffer + row * bitmap.pitch,
+                   bitmap.width);
+        }
+
+        if(pen_x + g.w + padding > atlas_w) {
+            pen_x = padding;
+            pen_y += shelf_h + padding;
+            shelf_h = 0;
+        }
+
+        glyph_x[i] = pen_x;
+        glyph_y[i] = pen_y;
+
+        pen_x += g.w + padding;
+        shelf_h = std::max(shelf_h, (int) g.h);
+    }
+
+    int atlas_h = 1;
+    while(atlas_h < pen_y + shelf_h + padding) atlas_h <<= 1;
+
+    std::vector<unsigned char> pixels(atlas_w * atlas_h, 0);
+
+    for(int i = 0; i < GLYPH_COUNT; i++) {
+
+        Glyph& g = glyphs[i];
+        if(bitmaps[i].empty()) continue;
+
+        for(int row = 0; row < (int) g.h; row++) {
+            memcpy(&pixels[(glyph_y[i] + row) * atlas_w + glyph_x[i]],
+                   &bitmaps[i][row * (int) g.w],
+                   (int) g.w);
+        }
+
+        g.u0 = glyph_x[i] / (float) atlas_w;
+        g.v0 = glyph_y[i] / (float) atlas_h;
+        g.u1 = (glyph_x[i] + g.w) / (float) atlas_w;
+        g.v1 = (glyph_y[i] + g.h) / (float) atlas_h;
+    }
+
+    kerning.clear();
+
+    if(FT_HAS_KERNING(face)) {
+        kerning.resize(GLYPH_COUNT * GLYPH_COUNT, 0.0f);
+
+        FT_UInt indices[GLYPH_COUNT];
+        for(int i = 0; i < GLYPH_COUNT; i++) {
+            indices[i] = FT_Get_Char_Index(face, FIRST_GLYPH + i);
+        }
+
+        for(int a = 0; a < GLYPH_COUNT; a++) {
+            for(int b = 0; b < GLYPH_COUNT; b++) {
+                FT_Vector delta;
+                FT_Get_Kerning(face, indices[a], indices[b], FT_KERNING_DEFAULT, &delta);
+                kerning[a * GLYPH_COUNT + b] = delta.x / 64.0f;
+            }
+        }
+    }
+
+    FT_Done_Face(face);
+    FT_Done_FreeType(library);
+
+    if(textureid!=0) glDeleteTextures(1, &textureid);
+
+    glGenTextures(1, &textureid);
+    glBindTexture(GL_TEXTURE_2D, textureid);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, atlas_w, atlas_h, 0,
+                 GL_ALPHA, GL_UNSIGNED_BYTE, &pixels[0]);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+void GlyphAtlas::shape(const std::string& text, ShapedText& out) const {
+    shape(text.c_str(), out);
+}
+
+void GlyphAtlas::shape(const char* text, ShapedText& out) const {
+
+    out.clear();
+
+    float pen = 0.0f;
+    int previous = -1;
+
+    for(size_t i = 0; text[i] != '\0'; i++) {
+
+        int index = glyphIndex(text[i]);
+        const Glyph& g = glyphs[index];
+
+        if(previous >= 0 && !kerning.empty()) {
+            pen += kerning[previous * GLYPH_COUNT + index];
+        }
+
+        if(g.w > 0 && g.h > 0) {
+            ShapedText::Quad q;
+            q.x0 = pen + g.left;
+            q.y0 = -g.top;
+            q.x1 = q.x0 + g.w;
+            q.y1 = q.y0 + g.h;
+            q.u0 = g.u0; q.v0 = g.v0;
+            q.u1 = g.u1; q.v1 = g.v1;
+
+            out.quads.push_back(q);
+        }
+
+        pen += g.advance;
+        previous = index;
+    }
+
+    out.width = pen;
+}
+
+// TextBatch
+
+TextBatch::TextBatch() :
+    atlas(nullptr),
+    shadow_offset(1.0, 1.0),
+    shadow_strength(0.7)
+{
+}
+
+void TextBatch::shadowStrength(float s) {
+    shadow_strength = s;
+}
+
+void TextBatch::shadowOffset(float x, float y) {
+    shadow_offset = vec2f(x,y);
+}
+
+void TextBatch::begin(const GlyphAtlas& atlas) {
+
+    this->atlas = &atlas;
+
+    shadows.clear();
+    glyphs.clear();
+
+    glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
+    glGetDoublev(GL_PROJECTION_MATRIX, projection);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+}
+
+vec2f TextBatch::project(const vec2f& pos) const {
+    GLdouble winX, winY, winZ;
+
+    gluProject(pos.x, pos.y, 0.0, modelview, projection, viewport, &winX, &winY, &winZ);
+
+    return vec2f((float) winX, (float) viewport[3] - (float) winY);
+}
+
+void TextBatch::append(std::vector<Vertex>& vertices, const ShapedText& text,
+                       float x, float y, float scale, const vec4f& col) {
+
+    for(const auto& q : text.quads) {
+        float x0 = x + q.x0 * scale, y0 = y + q.y0 * scale;
+        float x1 = x + q.x1 * scale, y1 = y + q.y1 * scale;
+
+        vertices.push_back({x0, y0, q.u0, q.v0, col.x, col.y, col.z, col.w});
+        vertices.push_back({x1, y0, q.u1, q.v0, col.x, col.y, col.z, col.w});
+        vertices.push_back({x1, y1, q.u1, q.v1, col.x, col.y, col.z, col.w});
+        vertices.push_back({x0, y1, q.u0, q.v1, col.x, col.y, col.z, col.w});
+    }
+}
+
+void TextBatch::add(const ShapedText& text, const vec2f& pos, float size, const vec4f& col) {
+
+    if(text.empty() || col.w <= 0.0f) return;
+
+    //never magnify the atlas, upscaled glyphs are blurry
+    float scale = std::min(1.0f, size / atlas->getSize());
+
+    vec2f screenpos = project(pos);
+
+    //same placement as FXFont::draw with alignTop and roundCoordinates
+    float x = roundf(screenpos.x);
+    float y = roundf(screenpos.y + atlas->getHeight() * scale);
+
+    append(shadows, text, x + shadow_offset.x, y + shadow_offset.y, scale,
+           vec4f(0.0f, 0.0f, 0.0f, shadow_strength * col.w));
+    append(glyphs, text, x, y, scale, col);
+}
+
+void TextBatch::draw() {
+
+    if(atlas == nullptr || glyphs.empty()) return;
+
+    //shadows first, then the text itself, in a single draw call
+    shadows.insert(shadows.end(), glyphs.begin(), glyphs.end());
+
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(0, display.width, display.height, 0, -1.0, 1.0);
+
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    glEnable(GL_BLEND);
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, atlas->getTexture());
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+
+    glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &shadows[0].x);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &shadows[0].u);
+    glColorPointer(4, GL_FLOAT, sizeof(Vertex), &shadows[0].r);
+
+    glDrawArrays(GL_QUADS, 0, shadows.size());
+
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+
+    shadows.clear();
+    glyphs.clear();
+}
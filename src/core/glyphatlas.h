@@ -0,0 +1,153 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GLYPH_ATLAS_H
+#define GLYPH_ATLAS_H
+
+#include "display.h"
+#include "vectors.h"
+#include "resource.h"
+
+#include <string>
+#include <vector>
+
+class GlyphAtlasException : public ResourceException {
+public:
+    GlyphAtlasException(std::string& font_file) : ResourceException(font_file) {}
+};
+
+/**
+ * A string laid out once against a GlyphAtlas: one quad per glyph, in
+ * pixels at the atlas size, relative to the pen origin on the baseline
+ * (y pointing down, as in display.mode2D()).
+ */
+class ShapedText {
+public:
+    struct Quad {
+        float x0, y0, x1, y1;
+        float u0, v0, u1, v1;
+    };
+
+    std::vector<Quad> quads;
+    float width;
+
+    ShapedText() : width(0.0f) {}
+
+    bool empty() const { return quads.empty(); }
+    void clear() { quads.clear(); width = 0.0f; }
+};
+
+/**
+ * Rasterizes the printable ASCII glyphs of a font face once into a single
+ * alpha texture, so that any number of strings can be drawn with one
+ * texture bind (see TextBatch).
+ *
+ * The atlas should be loaded at the largest pixel size it is drawn at:
+ * TextBatch only ever scales it down.
+ */
+class GlyphAtlas {
+
+    static const int FIRST_GLYPH = 32;
+    static const int LAST_GLYPH = 126;
+    static const int GLYPH_COUNT = LAST_GLYPH - FIRST_GLYPH + 1;
+
+    struct Glyph {
+        float advance;
+        float left, top;
+        float w, h;
+        float u0, v0, u1, v1;
+    };
+
+    GLuint textureid;
+    int pixel_size;
+
+    float ascender;
+    float descender;
+
+    Glyph glyphs[GLYPH_COUNT];
+
+    // kerning[a * GLYPH_COUNT + b], empty if the face has no kerning table
+    std::vector<float> kerning;
+
+    int glyphIndex(unsigned char c) const;
+public:
+    GlyphAtlas();
+    ~GlyphAtlas();
+
+    void load(std::string font_file, int pixel_size);
+
+    GLuint getTexture() const { return textureid; }
+    int getSize() const { return pixel_size; }
+
+    /** Same convention as FXFont::getHeight() */
+    float getHeight() const { return ascender + descender; }
+
+    void shape(const char* text, ShapedText& out) const;
+    void shape(const std::string& text, ShapedText& out) const;
+};
+
+/**
+ * Accumulates shaped strings (and their drop shadows) in screen space during
+ * a rendering pass and submits them as a single batch of textured quads.
+ *
+ * begin() captures the current projection and modelview matrices so that
+ * world positions can be projected without touching the GL state for
+ * every label.
+ */
+class TextBatch {
+
+    struct Vertex {
+        float x, y;
+        float u, v;
+        float r, g, b, a;
+    };
+
+    const GlyphAtlas* atlas;
+
+    std::vector<Vertex> shadows;
+    std::vector<Vertex> glyphs;
+
+    GLdouble modelview[16];
+    GLdouble projection[16];
+    GLint viewport[4];
+
+    vec2f shadow_offset;
+    float shadow_strength;
+
+    void append(std::vector<Vertex>& vertices, const ShapedText& text,
+                float x, float y, float scale, const vec4f& col);
+public:
+    TextBatch();
+
+    void begin(const GlyphAtlas& atlas);
+
+    vec2f project(const vec2f& pos) const;
+
+    /**
+     * Queues 'text' at the screen projection of the world position 'pos',
+     * rendered at 'size' pixels. Sizes above the atlas size are drawn at
+     * the atlas size rather than magnified.
+     */
+    void add(const ShapedText& text, const vec2f& pos, float size, const vec4f& col);
+
+    void draw();
+
+    void shadowStrength(float s);
+    void shadowOffset(float x, float y);
+};
+
+#endif
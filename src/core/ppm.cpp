@@ -0,0 +1,360 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+    Copyright (C) 2009 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ppm.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+// FrameExporter
+
+FrameExporter::FrameExporter(const std::string& outputfile, int framerate) :
+    async(false),
+    fbo(0),
+    colour_rb(0),
+    depth_rb(0),
+    frame_index(0),
+    finished(false),
+    width(display.width),
+    height(display.height),
+    framerate(framerate)
+{
+    for(int i = 0; i < PBO_COUNT; i++) pbos[i] = 0;
+
+    if(outputfile == "-") {
+        output = stdout;
+    } else {
+        output = fopen(outputfile.c_str(), "wb");
+        if(!output) throw FrameExporterException(outputfile);
+    }
+
+    for(int i = 0; i < QUEUE_DEPTH; i++) {
+        free_buffers.push_back(std::vector<unsigned char>(width * height * 4));
+    }
+
+    setupOffscreen();
+}
+
+FrameExporter::~FrameExporter() {
+
+    //the writer thread calls virtual methods: it must be stopped by finish()
+    //before the subclass is destroyed
+    if(writer.joinable()) {
+        debugLog("FrameExporter destroyed without calling finish()\n");
+        std::terminate();
+    }
+
+    if(output != stdout) fclose(output);
+
+#ifdef SDLAPP_SHADER_SUPPORT
+    if(async) {
+        glDeleteBuffers(PBO_COUNT, pbos);
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteRenderbuffers(1, &colour_rb);
+        glDeleteRenderbuffers(1, &depth_rb);
+    }
+#endif
+}
+
+void FrameExporter::setupOffscreen() {
+
+#ifdef SDLAPP_SHADER_SUPPORT
+    if(!gShadersEnabled || !GLEW_ARB_framebuffer_object || !GLEW_ARB_pixel_buffer_object) {
+        debugLog("framebuffer or pixel buffer objects not supported: frames will be read synchronously\n");
+        return;
+    }
+
+    glGenRenderbuffers(1, &colour_rb);
+    glBindRenderbuffer(GL_RENDERBUFFER, colour_rb);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &depth_rb);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_rb);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colour_rb);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth_rb);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if(status != GL_FRAMEBUFFER_COMPLETE) {
+        debugLog("offscreen framebuffer incomplete (0x%x): frames will be read synchronously\n", status);
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteRenderbuffers(1, &colour_rb);
+        glDeleteRenderbuffers(1, &depth_rb);
+        return;
+    }
+
+    glGenBuffers(PBO_COUNT, pbos);
+    for(int i = 0; i < PBO_COUNT; i++) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, width * height * 4, 0, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    async = true;
+#endif
+}
+
+void FrameExporter::begin() {
+#ifdef SDLAPP_SHADER_SUPPORT
+    if(async) glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+#endif
+}
+
+std::vector<unsigned char> FrameExporter::acquireBuffer() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    //if the writer lags behind, we have to wait: frames can not be dropped
+    cond.wait(lock, [this]{ return !free_buffers.empty(); });
+
+    std::vector<unsigned char> buffer;
+    buffer.swap(free_buffers.back());
+    free_buffers.pop_back();
+
+    return buffer;
+}
+
+void FrameExporter::queueFrame(std::vector<unsigned char>& frame) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending_frames.push_back(std::vector<unsigned char>());
+        pending_frames.back().swap(frame);
+    }
+    cond.notify_all();
+}
+
+void FrameExporter::collect(int pbo) {
+#ifdef SDLAPP_SHADER_SUPPORT
+    std::vector<unsigned char> frame = acquireBuffer();
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[pbo]);
+
+    void* pixels = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if(pixels) {
+        memcpy(&frame[0], pixels, width * height * 4);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+
+    queueFrame(frame);
+#endif
+}
+
+void FrameExporter::capture() {
+
+    if(!writer.joinable()) {
+        writer = std::thread(&FrameExporter::writerLoop, this);
+    }
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+#ifdef SDLAPP_SHADER_SUPPORT
+    if(async) {
+        int current = frame_index % PBO_COUNT;
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[current]);
+        glReadPixels(0, 0, width, height, GL_BGRA, GL_UNSIGNED_BYTE, 0);
+
+        //the oldest transfer had PBO_COUNT - 1 frames to complete
+        if(frame_index >= PBO_COUNT - 1) {
+            collect((frame_index - (PBO_COUNT - 1)) % PBO_COUNT);
+        }
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        //show the frame in the window as well
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        frame_index++;
+        return;
+    }
+#endif
+
+    std::vector<unsigned char> frame = acquireBuffer();
+
+    glReadBuffer(GL_BACK);
+    glReadPixels(0, 0, width, height, GL_BGRA, GL_UNSIGNED_BYTE, &frame[0]);
+
+    queueFrame(frame);
+
+    frame_index++;
+}
+
+void FrameExporter::finish() {
+
+    if(!writer.joinable()) return;
+
+#ifdef SDLAPP_SHADER_SUPPORT
+    if(async) {
+        //collect the transfers still in flight, oldest first
+        long first = std::max(0L, frame_index - (PBO_COUNT - 1));
+        for(long i = first; i < frame_index; i++) {
+            collect(i % PBO_COUNT);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+#endif
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = true;
+    }
+    cond.notify_all();
+
+    writer.join();
+
+    fflush(output);
+}
+
+void FrameExporter::writerLoop() {
+
+    writeHeader();
+
+    while(true) {
+        std::vector<unsigned char> frame;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cond.wait(lock, [this]{ return finished || !pending_frames.empty(); });
+
+            if(pending_frames.empty()) break; // finished, and nothing left
+
+            frame.swap(pending_frames.front());
+            pending_frames.pop_front();
+        }
+
+        writeFrame(&frame[0]);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            free_buffers.push_back(std::vector<unsigned char>());
+            free_buffers.back().swap(frame);
+        }
+        cond.notify_all();
+    }
+}
+
+// PPMExporter
+
+PPMExporter::PPMExporter(const std::string& outputfile, int framerate) :
+    FrameExporter(outputfile, framerate),
+    rgb(width * height * 3)
+{
+}
+
+PPMExporter::~PPMExporter() {
+    finish();
+}
+
+void PPMExporter::writeFrame(const unsigned char* bgra) {
+
+    char header[64];
+    snprintf(header, 64, "P6\n%d %d 255\n", width, height);
+
+    //GL rows are bottom-up
+    for(int row = 0; row < height; row++) {
+        const unsigned char* src = bgra + (height - 1 - row) * width * 4;
+        unsigned char* dst = &rgb[row * width * 3];
+
+        for(int x = 0; x < width; x++, src += 4, dst += 3) {
+            dst[0] = src[2];
+            dst[1] = src[1];
+            dst[2] = src[0];
+        }
+    }
+
+    fwrite(header, 1, strlen(header), output);
+    fwrite((const char*) &rgb[0], 1, rgb.size(), output);
+}
+
+// Y4MExporter
+
+Y4MExporter::Y4MExporter(const std::string& outputfile, int framerate) :
+    FrameExporter(outputfile, framerate),
+    y(width * height),
+    u(((width + 1) / 2) * ((height + 1) / 2)),
+    v(((width + 1) / 2) * ((height + 1) / 2))
+{
+}
+
+Y4MExporter::~Y4MExporter() {
+    finish();
+}
+
+void Y4MExporter::writeHeader() {
+    char header[128];
+    snprintf(header, 128, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, framerate);
+    fwrite(header, 1, strlen(header), output);
+}
+
+void Y4MExporter::writeFrame(const unsigned char* bgra) {
+
+    int chroma_w = (width + 1) / 2;
+    int chroma_h = (height + 1) / 2;
+
+    for(int row = 0; row < height; row++) {
+        const unsigned char* src = bgra + (height - 1 - row) * width * 4;
+        unsigned char* dst = &y[row * width];
+
+        for(int x = 0; x < width; x++, src += 4) {
+            int b = src[0], g = src[1], r = src[2];
+            dst[x] = (unsigned char) ((77 * r + 150 * g + 29 * b + 128) >> 8);
+        }
+    }
+
+    //chroma is averaged over 2x2 blocks
+    for(int cy = 0; cy < chroma_h; cy++) {
+        for(int cx = 0; cx < chroma_w; cx++) {
+
+            int r = 0, g = 0, b = 0, n = 0;
+
+            for(int dy = 0; dy < 2; dy++) {
+                int row = cy * 2 + dy;
+                if(row >= height) continue;
+
+                for(int dx = 0; dx < 2; dx++) {
+                    int x = cx * 2 + dx;
+                    if(x >= width) continue;
+
+                    const unsigned char* src = bgra + ((height - 1 - row) * width + x) * 4;
+                    b += src[0]; g += src[1]; r += src[2];
+                    n++;
+                }
+            }
+
+            r /= n; g /= n; b /= n;
+
+            u[cy * chroma_w + cx] = (unsigned char) std::min(255, std::max(0, ((-43 * r - 85 * g + 128 * b + 128) >> 8) + 128));
+            v[cy * chroma_w + cx] = (unsigned char) std::min(255, std::max(0, ((128 * r - 107 * g - 21 * b + 128) >> 8) + 128));
+        }
+    }
+
+    fwrite("FRAME\n", 1, 6, output);
+    fwrite((const char*) &y[0], 1, y.size(), output);
+    fwrite((const char*) &u[0], 1, u.size(), output);
+    fwrite((const char*) &v[0], 1, v.size(), output);
+}
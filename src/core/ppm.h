@@ -0,0 +1,149 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+    Copyright (C) 2009 Andrew Caudwell (acaudwell@gmail.com)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PPM_FRAME_EXPORTER_H
+#define PPM_FRAME_EXPORTER_H
+
+#include "display.h"
+
+#include <condition_variable>
+#include <deque>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class FrameExporterException : public std::exception {
+protected:
+    std::string filename;
+public:
+    FrameExporterException(const std::string& filename) : filename(filename) {}
+    virtual ~FrameExporterException() throw () {};
+
+    virtual const char* what() const throw() { return filename.c_str(); }
+};
+
+/**
+ * Captures rendered frames and streams them to a file (or stdout) from a
+ * writer thread.
+ *
+ * When framebuffer and pixel buffer objects are available, begin() redirects
+ * rendering to an offscreen framebuffer, and capture() starts an
+ * asynchronous read back of the frame into a ring of PBOs. A PBO is only
+ * mapped PBO_COUNT - 1 frames later, when its transfer is complete, so that
+ * the render loop does not wait for the GPU. Otherwise, frames are read back
+ * synchronously from the back buffer.
+ *
+ * Frames are encoded by the subclasses, from bottom-up BGRA pixels. They
+ * are written with stdio, so that redirecting std::cout does not affect
+ * a stream sent to stdout.
+ */
+class FrameExporter {
+
+    static const int PBO_COUNT = 3;
+    static const int QUEUE_DEPTH = 8;
+
+    bool async;
+
+    GLuint fbo;
+    GLuint colour_rb, depth_rb;
+    GLuint pbos[PBO_COUNT];
+
+    // number of frames captured so far
+    long frame_index;
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::vector<std::vector<unsigned char>> free_buffers;
+    std::deque<std::vector<unsigned char>> pending_frames;
+    bool finished;
+
+    std::thread writer;
+
+    void setupOffscreen();
+
+    std::vector<unsigned char> acquireBuffer();
+    void queueFrame(std::vector<unsigned char>& frame);
+    void collect(int pbo);
+
+    void writerLoop();
+
+protected:
+    int width, height;
+    int framerate;
+
+    FILE* output;
+
+    virtual void writeHeader() {};
+    virtual void writeFrame(const unsigned char* bgra) = 0;
+
+public:
+    FrameExporter(const std::string& outputfile, int framerate);
+    virtual ~FrameExporter();
+
+    int getFramerate() const { return framerate; }
+
+    /** Redirects rendering to the offscreen framebuffer, if available.
+     */
+    void begin();
+
+    /** Reads back the frame rendered since begin(), and displays it.
+     */
+    void capture();
+
+    /** Writes the frames still in flight, and stops the writer thread.
+     * Must be called before the exporter is destroyed (the destructors of
+     * the exporters below do it), while the GL context is still alive.
+     */
+    void finish();
+};
+
+/**
+ * Raw PPM (P6) stream, one image per frame.
+ */
+class PPMExporter : public FrameExporter {
+
+    std::vector<unsigned char> rgb;
+
+protected:
+    void writeFrame(const unsigned char* bgra) override;
+
+public:
+    PPMExporter(const std::string& outputfile, int framerate);
+    ~PPMExporter();
+};
+
+/**
+ * YUV4MPEG2 stream (4:2:0, full range BT.601), that can be fed directly to
+ * most video encoders.
+ */
+class Y4MExporter : public FrameExporter {
+
+    std::vector<unsigned char> y, u, v;
+
+protected:
+    void writeHeader() override;
+    void writeFrame(const unsigned char* bgra) override;
+
+public:
+    Y4MExporter(const std::string& outputfile, int framerate);
+    ~Y4MExporter();
+};
+
+#endif
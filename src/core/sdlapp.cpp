@@ -273,8 +273,10 @@ int SDLApp::run() {
         }
 
         //process new events
+        bool events = false;
         SDL_Event event;
         while ( SDL_PollEvent(&event) ) {
+            events = true;
 
             switch(event.type) {
                 case SDL_QUIT:
@@ -306,6 +308,12 @@ int SDLApp::run() {
             }
         }
 
+        //nothing changed on screen since the last frame
+        if(!events && isIdle()) {
+            idle(dt);
+            continue;
+        }
+
         update(t, dt);
 
 #ifndef TEXT_ONLY
@@ -89,6 +89,12 @@ public:
     virtual void logic(float t, float dt) {};
     virtual void draw(float t, float dt) {};
 
+    // When isIdle() returns true and no event is pending, the frame is
+    // neither updated nor swapped: idle() is called instead, and is
+    // expected to block for a short while.
+    virtual bool isIdle() { return false; };
+    virtual void idle(float dt) { SDL_Delay(10); };
+
     virtual void mouseMove(SDL_MouseMotionEvent *e) {};
     virtual void mouseClick(SDL_MouseButtonEvent *e) {};
     virtual void keyPress(SDL_KeyboardEvent *e) {};
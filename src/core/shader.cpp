@@ -0,0 +1,59 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "shader.h"
+
+#ifdef SDLAPP_SHADER_SUPPORT
+
+GLuint createFragmentProgram(const char* fragment_source) {
+
+    GLuint shader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(shader, 1, &fragment_source, 0);
+    glCompileShader(shader);
+
+    GLint status;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+
+    if(!status) {
+        char log[1024];
+        glGetShaderInfoLog(shader, 1024, 0, log);
+        debugLog("shader compilation failed: %s\n", log);
+        glDeleteShader(shader);
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, shader);
+    glLinkProgram(program);
+
+    // the program keeps the shader alive
+    glDeleteShader(shader);
+
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+
+    if(!status) {
+        char log[1024];
+        glGetProgramInfoLog(program, 1024, 0, log);
+        debugLog("shader link failed: %s\n", log);
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
+
+#endif
@@ -0,0 +1,32 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SDLAPP_SHADER_H
+#define SDLAPP_SHADER_H
+
+#include "display.h"
+
+#ifdef SDLAPP_SHADER_SUPPORT
+
+// Compiles and links a GLSL program made of a single fragment shader (the
+// vertex stage is left to the fixed pipeline). Returns 0, and logs the
+// error, if compilation or linking fails.
+GLuint createFragmentProgram(const char* fragment_source);
+
+#endif
+
+#endif
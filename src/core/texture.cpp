@@ -27,11 +27,165 @@
 
 #include "texture.h"
 
+#include <algorithm>
+
 TextureManager texturemanager;
 
 // texture manager
 
 TextureManager::TextureManager() : ResourceManager() {
+    atlas_id = 0;
+    atlas_w  = 0;
+    atlas_h  = 0;
+}
+
+void TextureManager::purge() {
+    if(atlas_id!=0) glDeleteTextures(1, &atlas_id);
+    atlas_id = 0;
+
+    regions.clear();
+
+    ResourceManager::purge();
+}
+
+void TextureManager::addSprite(std::string file) {
+    if(std::find(sprites.begin(), sprites.end(), file) == sprites.end()) {
+        sprites.push_back(file);
+    }
+}
+
+const TextureRegion& TextureManager::getSprite(std::string file) {
+    std::map<std::string, TextureRegion>::iterator it = regions.find(file);
+
+    if(it == regions.end()) throw TextureException(file);
+
+    return it->second;
+}
+
+void TextureManager::buildAtlas(int padding) {
+
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+    Uint32 rmask = 0xff000000, gmask = 0x00ff0000, bmask = 0x0000ff00, amask = 0x000000ff;
+#else
+    Uint32 rmask = 0x000000ff, gmask = 0x0000ff00, bmask = 0x00ff0000, amask = 0xff000000;
+#endif
+
+    struct Sprite {
+        std::string name;
+        SDL_Surface* surface;
+        int x, y;
+    };
+
+    std::vector<Sprite> images;
+
+    int max_w = 0;
+    int area  = 0;
+
+    for(size_t i=0; i<sprites.size(); i++) {
+        std::string file = getDir() + sprites[i];
+
+        SDL_Surface* loaded = IMG_Load(file.c_str());
+        if(loaded==0) {
+            for(size_t j=0; j<images.size(); j++) SDL_FreeSurface(images[j].surface);
+            throw TextureException(file);
+        }
+
+        //convert to RGBA, copying the alpha channel instead of blending
+        SDL_Surface* rgba = SDL_CreateRGBSurface(SDL_SWSURFACE, loaded->w, loaded->h, 32, rmask, gmask, bmask, amask);
+        SDL_SetAlpha(loaded, 0, 0);
+        SDL_BlitSurface(loaded, 0, rgba, 0);
+        SDL_FreeSurface(loaded);
+
+        Sprite sprite = { sprites[i], rgba, 0, 0 };
+        images.push_back(sprite);
+
+        max_w = std::max(max_w, rgba->w + 2 * padding);
+        area += (rgba->w + 2 * padding) * (rgba->h + 2 * padding);
+    }
+
+    //shelf packing, tallest sprites first
+    std::vector<Sprite*> order;
+    for(size_t i=0; i<images.size(); i++) order.push_back(&images[i]);
+
+    std::sort(order.begin(), order.end(), [](const Sprite* a, const Sprite* b) {
+        return a->surface->h > b->surface->h;
+    });
+
+    atlas_w = 64;
+    while(atlas_w < max_w || atlas_w * atlas_w < area) atlas_w *= 2;
+
+    int x = 0, y = 0, shelf_h = 0;
+
+    for(size_t i=0; i<order.size(); i++) {
+        int w = order[i]->surface->w + 2 * padding;
+        int h = order[i]->surface->h + 2 * padding;
+
+        if(x + w > atlas_w) {
+            x = 0;
+            y += shelf_h;
+            shelf_h = 0;
+        }
+
+        order[i]->x = x;
+        order[i]->y = y;
+
+        x += w;
+        shelf_h = std::max(shelf_h, h);
+    }
+
+    atlas_h = 64;
+    while(atlas_h < y + shelf_h) atlas_h *= 2;
+
+    std::vector<unsigned int> pixels(atlas_w * atlas_h, 0);
+
+    regions.clear();
+
+    for(size_t i=0; i<images.size(); i++) {
+        Sprite& sprite = images[i];
+        SDL_Surface* surface = sprite.surface;
+
+        SDL_LockSurface(surface);
+
+        //padding is filled with the nearest border pixel
+        for(int dy = 0; dy < surface->h + 2 * padding; dy++) {
+            int sy = std::min(std::max(dy - padding, 0), surface->h - 1);
+            const unsigned int* src = (const unsigned int*) ((const char*) surface->pixels + sy * surface->pitch);
+            unsigned int* dst = &pixels[(sprite.y + dy) * atlas_w + sprite.x];
+
+            for(int dx = 0; dx < surface->w + 2 * padding; dx++) {
+                int sx = std::min(std::max(dx - padding, 0), surface->w - 1);
+                dst[dx] = src[sx];
+            }
+        }
+
+        SDL_UnlockSurface(surface);
+
+        TextureRegion region;
+        region.w  = surface->w;
+        region.h  = surface->h;
+        region.u0 = (float) (sprite.x + padding) / atlas_w;
+        region.v0 = (float) (sprite.y + padding) / atlas_h;
+        region.u1 = (float) (sprite.x + padding + surface->w) / atlas_w;
+        region.v1 = (float) (sprite.y + padding + surface->h) / atlas_h;
+
+        regions[sprite.name] = region;
+
+        SDL_FreeSurface(surface);
+    }
+
+    if(atlas_id!=0) glDeleteTextures(1, &atlas_id);
+
+    atlas_id = display.createTexture(atlas_w, atlas_h, true, true, false, GL_RGBA, &pixels[0]);
+
+    //sprites are not aligned on power-of-two cells: only the mipmap levels
+    //where the padding still spans 2 texels (one for the misaligned
+    //downsampling, one for bilinear filtering) are free of bleeding
+    int max_level = 0;
+    while((padding >> (max_level + 1)) >= 2) max_level++;
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, max_level);
+
+    debugLog("packed %d sprites in a %dx%d texture atlas\n", (int) images.size(), atlas_w, atlas_h);
 }
 
 TextureResource* TextureManager::grab(std::string name, int mipmaps, int clamp, int trilinear, bool external_file) {
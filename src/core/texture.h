@@ -30,6 +30,10 @@
 
 #include "SDL_image.h"
 
+#include <map>
+#include <string>
+#include <vector>
+
 #include "resource.h"
 #include "display.h"
 
@@ -48,10 +52,45 @@ public:
     ~TextureResource();
 };
 
+// Sub-rectangle of a sprite in the texture atlas
+class TextureRegion {
+public:
+    int w, h;
+    float u0, v0, u1, v1;
+
+    TextureRegion() : w(0), h(0), u0(0.0f), v0(0.0f), u1(1.0f), v1(1.0f) {}
+
+    // maps texture coordinates of the sprite to atlas coordinates
+    float u(float s) const { return u0 + (u1 - u0) * s; }
+    float v(float t) const { return v0 + (v1 - v0) * t; }
+};
+
 class TextureManager : public ResourceManager {
+    std::vector<std::string> sprites;
+    std::map<std::string, TextureRegion> regions;
+
+    GLuint atlas_id;
+    int atlas_w, atlas_h;
 public:
     TextureManager();
     TextureResource* grab(std::string file, int mipmaps=1, int clamp=1, int trilinear=0, bool external_file = false);
+
+    // registers a sprite, to be packed by buildAtlas()
+    void addSprite(std::string file);
+
+    // packs all the registered sprites in a single texture. Sprites are
+    // separated by 'padding' pixels, filled with their border pixels so
+    // that filtering does not bleed from one sprite to another. Mipmaps are
+    // only used down to the level where the padding still covers that.
+    void buildAtlas(int padding = 4);
+
+    // region of a sprite in the atlas (throws a TextureException if the
+    // sprite is not in the atlas)
+    const TextureRegion& getSprite(std::string file);
+
+    GLuint getAtlas() const { return atlas_id; }
+
+    void purge();
 };
 
 extern TextureManager texturemanager;
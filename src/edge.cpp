@@ -44,6 +44,8 @@ Edge::Edge(const NodeRelation& rel, double weight) :
     spring_constant = INITIAL_SPRING_CONSTANT * weight;
     nominal_length = NOMINAL_EDGE_LENGTH;
 
+    weight_colour = WEIGHT_COLOURS(weight);
+
     length = 0.0;
 }
 
@@ -120,43 +122,30 @@ vec4f Edge::computeColour() const {
         col = HOVERED_COLOUR;
     }
     else {
-        if (weight > 0) {
-            col = vec4f((float) weight, (float) weight * 0.5, 0, 0.7);
-        }
-        else {
-            col = vec4f(0,0, (float) -weight, 0.7);
-        }
+        col = weight_colour;
     }
 
     return col;
 }
 
-void Edge::render(rendering_mode mode, MemoryView& env){
+void Edge::build(RenderLayers& layers, MemoryView& env){
 
+#ifndef TEXT_ONLY
+    if (layers.labelsEnabled()) renderer.setWeight(weight);
 
+    renderer.build(layers, env);
+#endif
+}
 
-#ifndef TEXT_ONLY
-    if (mode == GRAPHVIZ and !std::isnan(weight)) {
-        std::stringstream str;
-        auto col = computeColour();
-        str << "#" << setfill('0') << setw(2) << hex << (int) floor(col.x * 256) << setw(2) << (int) floor(col.y * 256) << setw(2) << (int) floor(col.z * 256);
+void Edge::toGraphViz(MemoryView& env){
 
-        env.graphvizGraph << node1->getSafeID() << " -- " << node2->getSafeID() << " [label=" << fixed << setprecision( 2 ) << weight <<", color=\"" << str.str() << "\"];\n";
-        return;
-    }
+    if (std::isnan(weight)) return;
 
-    if (std::isnan(weight)) {
-        renderer.label = "";
-    }
-    else {
-        std::stringstream str;
-        str << fixed << setprecision( 2 ) << weight;
-        renderer.label = str.str();
-    }
-    renderer.draw(mode, env);
-#endif
-    //TRACE("Edge between " << node1->getID() << " and " << node2->getID() << " rendered.");
+    std::stringstream str;
+    auto col = computeColour();
+    str << "#" << setfill('0') << setw(2) << hex << (int) floor(col.x * 256) << setw(2) << (int) floor(col.y * 256) << setw(2) << (int) floor(col.z * 256);
 
+    env.graphvizGraph << node1->getSafeID() << " -- " << node2->getSafeID() << " [label=" << fixed << setprecision( 2 ) << weight <<", color=\"" << str.str() << "\"];\n";
 }
 
 void Edge::updateLength() {
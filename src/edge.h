@@ -42,6 +42,9 @@ class Edge
 
     EdgeRenderer renderer;
 
+    // colour of the weight, from WEIGHT_COLOURS
+    vec4f weight_colour;
+
     vec4f computeColour() const;
 
 public:
@@ -53,9 +56,20 @@ public:
     float nominal_length;
 
     void step(Graph& g, float dt);
-    void render(rendering_mode mode, MemoryView& env);
+    /** Adds the edge to the layers of the frame
+     */
+    void build(RenderLayers& layers, MemoryView& env);
+
+    /** Writes the edge to env.graphvizGraph, in dot format
+     */
+    void toGraphViz(MemoryView& env);
 
     void setWeight(double weight);
+    void setWeightColour(const vec4f& col) {weight_colour = col;}
+
+    /** True if one of the two nodes is hovered or selected
+     */
+    bool highlighted() const {return renderer.selected;}
 
     int getId1() const;
     int getId2() const;
@@ -0,0 +1,292 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "graph.h"
+#include "edge.h"
+#include "styles.h"
+
+#include "edge_bundler.h"
+
+using namespace std;
+
+// the layout is re-clustered at most every CLUSTERING_PERIOD seconds
+static const float CLUSTERING_PERIOD = 0.5;
+// Lloyd iterations per clustering (starting from the previous centroids)
+static const int KMEANS_ITERATIONS = 5;
+static const size_t MAX_CLUSTERS = 64;
+
+// bundle half-width, per unit of summed |weight|, and maximum
+static const float BUNDLE_WIDTH = 0.5;
+static const float MAX_BUNDLE_RADIUS = 12.0;
+
+EdgeBundler::EdgeBundler() :
+    enabled(false),
+    since_clustering(CLUSTERING_PERIOD),
+    stop(false),
+    pending(false),
+    published(false),
+    published_count(0),
+    cluster_count(0)
+{
+}
+
+EdgeBundler::~EdgeBundler() {
+
+    {
+        lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    wakeup.notify_one();
+
+    if (worker.joinable()) worker.join();
+}
+
+void EdgeBundler::setEnabled(bool enabled) {
+    this->enabled = enabled;
+
+    // started on first use
+    if (enabled && !worker.joinable()) worker = thread(&EdgeBundler::run, this);
+
+    since_clustering = CLUSTERING_PERIOD;
+}
+
+void EdgeBundler::update(const Graph& g, float dt) {
+
+    if (!enabled) return;
+
+    since_clustering += dt;
+    if (since_clustering < CLUSTERING_PERIOD) return;
+    since_clustering = 0.0;
+
+    {
+        lock_guard<std::mutex> lock(mutex);
+
+        snapshot_ids.clear();
+        snapshot_positions.clear();
+
+        for (const auto& n : g.getNodes()) {
+            snapshot_ids.push_back(n.first);
+            snapshot_positions.push_back(n.second.pos);
+        }
+
+        pending = true;
+    }
+
+    wakeup.notify_one();
+}
+
+void EdgeBundler::run() {
+
+    vector<int> ids;
+    vector<vec2f> positions;
+
+    while (true) {
+        {
+            unique_lock<std::mutex> lock(mutex);
+            wakeup.wait(lock, [this]{return stop || pending;});
+
+            if (stop) return;
+
+            ids.swap(snapshot_ids);
+            positions.swap(snapshot_positions);
+            pending = false;
+        }
+
+        cluster(ids, positions);
+    }
+}
+
+void EdgeBundler::cluster(const vector<int>& ids, const vector<vec2f>& positions) {
+
+    size_t n = positions.size();
+    if (n == 0) return;
+
+    size_t k = min(MAX_CLUSTERS, max((size_t) 1, (size_t) round(sqrt(n / 2.0))));
+
+    vector<int> assignment(n, 0);
+    vector<float> distance(n, 0.0f);
+
+    if (centroids.size() > k) centroids.resize(k);
+
+    // new clusters are seeded on the node furthest from the existing
+    // centroids
+    while (centroids.size() < k) {
+        size_t furthest = 0;
+        float max_distance = -1.0;
+
+        for (size_t i = 0; i < n; i++) {
+            float d = numeric_limits<float>::max();
+            for (const auto& c : centroids) d = min(d, (positions[i] - c).length2());
+            if (d > max_distance) {
+                max_distance = d;
+                furthest = i;
+            }
+        }
+
+        centroids.push_back(positions[furthest]);
+    }
+
+    vector<vec2f> sums(k);
+    vector<int> sizes(k);
+
+    for (int iteration = 0; iteration < KMEANS_ITERATIONS; iteration++) {
+
+        for (size_t i = 0; i < n; i++) {
+            float best = numeric_limits<float>::max();
+            for (size_t c = 0; c < k; c++) {
+                float d = (positions[i] - centroids[c]).length2();
+                if (d < best) {
+                    best = d;
+                    assignment[i] = c;
+                }
+            }
+            distance[i] = best;
+        }
+
+        fill(sums.begin(), sums.end(), vec2f(0.0, 0.0));
+        fill(sizes.begin(), sizes.end(), 0);
+
+        for (size_t i = 0; i < n; i++) {
+            sums[assignment[i]] += positions[i];
+            sizes[assignment[i]]++;
+        }
+
+        for (size_t c = 0; c < k; c++) {
+            if (sizes[c] > 0) {
+                centroids[c] = sums[c] / (float) sizes[c];
+            }
+            else {
+                // empty cluster: moved to the node the worst represented
+                size_t worst = max_element(distance.begin(), distance.end()) - distance.begin();
+                centroids[c] = positions[worst];
+                distance[worst] = 0.0;
+            }
+        }
+    }
+
+    int max_id = *max_element(ids.begin(), ids.end());
+
+    lock_guard<std::mutex> lock(mutex);
+
+    published_clusters.assign(max_id + 1, -1);
+    for (size_t i = 0; i < n; i++) published_clusters[ids[i]] = assignment[i];
+
+    published_count = k;
+    published = true;
+}
+
+void EdgeBundler::begin(const Graph& g) {
+
+    {
+        lock_guard<std::mutex> lock(mutex);
+
+        if (published) {
+            clusters.swap(published_clusters);
+            cluster_count = published_count;
+            published = false;
+        }
+    }
+
+    cluster_pos.assign(cluster_count, vec2f(0.0, 0.0));
+    cluster_size.assign(cluster_count, 0);
+
+    for (const auto& n : g.getNodes()) {
+        if (n.first >= (int) clusters.size() || clusters[n.first] < 0) continue;
+
+        cluster_pos[clusters[n.first]] += n.second.pos;
+        cluster_size[clusters[n.first]]++;
+    }
+
+    for (size_t c = 0; c < cluster_count; c++) {
+        if (cluster_size[c] > 0) cluster_pos[c] /= (float) cluster_size[c];
+    }
+
+    bundle_weight.assign(cluster_count * cluster_count, 0.0f);
+    bundle_sign.assign(cluster_count * cluster_count, 0.0f);
+}
+
+bool EdgeBundler::add(const Edge& edge) {
+
+    int id1 = edge.getId1(), id2 = edge.getId2();
+
+    if (id1 >= (int) clusters.size() || id2 >= (int) clusters.size()) return false;
+
+    int c1 = clusters[id1], c2 = clusters[id2];
+
+    if (c1 < 0 || c2 < 0) return false;
+
+    // edges within a cluster are not drawn
+    if (c1 == c2 || std::isnan(edge.weight)) return true;
+
+    size_t bundle = min(c1, c2) * cluster_count + max(c1, c2);
+
+    bundle_weight[bundle] += fabs(edge.weight);
+    bundle_sign[bundle] += edge.weight;
+
+    return true;
+}
+
+void EdgeBundler::buildBundle(RenderLayers& layers, const vec2f& p1, const vec2f& p2,
+                              float radius, const vec4f& col, bool shadow) {
+
+    vec2f a = p1, b = p2;
+    vec4f c = col;
+
+    if (shadow) {
+        a += SHADOW_OFFSET;
+        b += SHADOW_OFFSET;
+        c = vec4f(0.0, 0.0, 0.0, SHADOW_STRENGTH * col.w);
+        radius += 2.0;
+    }
+
+    vec2f perp = (a - b).perpendicular().normal() * radius;
+
+    render_layer layer = shadow ? LAYER_EDGE_SHADOWS : LAYER_EDGES;
+
+    layers.vertex(layer, a + perp, 1.0, 0.0, c);
+    layers.vertex(layer, a - perp, 0.0, 0.0, c);
+    layers.vertex(layer, b - perp, 0.0, 0.0, c);
+    layers.vertex(layer, b + perp, 1.0, 0.0, c);
+}
+
+void EdgeBundler::build(RenderLayers& layers) {
+
+    bool shadows = layers.isEnabled(LAYER_EDGE_SHADOWS);
+
+    for (size_t c1 = 0; c1 < cluster_count; c1++) {
+        for (size_t c2 = c1 + 1; c2 < cluster_count; c2++) {
+
+            size_t bundle = c1 * cluster_count + c2;
+            float weight = bundle_weight[bundle];
+
+            if (weight <= 0.0f) continue;
+
+            float radius = min(MAX_BUNDLE_RADIUS, 0.5f + weight * BUNDLE_WIDTH);
+
+            // same colours as the edges: the more the weights agree, the
+            // brighter the bundle
+            vec4f col = WEIGHT_COLOURS(bundle_sign[bundle] / weight);
+
+            if (shadows) buildBundle(layers, cluster_pos[c1], cluster_pos[c2], radius, col, true);
+            buildBundle(layers, cluster_pos[c1], cluster_pos[c2], radius, col, false);
+        }
+    }
+}
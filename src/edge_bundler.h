@@ -0,0 +1,119 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef EDGE_BUNDLER_H
+#define EDGE_BUNDLER_H
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "core/vectors.h"
+
+#include "render_layers.h"
+
+class Graph;
+class Edge;
+
+/**
+ * Edge aggregation for dense graphs.
+ *
+ * Nodes are clustered by proximity in the layout (k-means, with about
+ * sqrt(N/2) clusters). Instead of N^2 individual edges, one bundle is drawn
+ * between each pair of clusters, as thick as the sum of the absolute weights
+ * of the edges it aggregates, and coloured after their sign. Edges within a
+ * cluster are not drawn. The edges of hovered or selected nodes are still
+ * drawn individually.
+ *
+ * The clustering runs in a background thread, on a snapshot of the node
+ * positions taken every CLUSTERING_PERIOD. Each run starts from the
+ * previous centroids, so clusters are stable while the layout evolves.
+ * Bundle extremities are the centroids of the clusters, recomputed every
+ * frame from the current positions.
+ */
+class EdgeBundler {
+
+    bool enabled;
+
+    float since_clustering;
+
+    // background clustering
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    bool stop;
+
+    bool pending; // a snapshot is waiting to be clustered
+    std::vector<int> snapshot_ids;
+    std::vector<vec2f> snapshot_positions;
+
+    bool published; // a new assignment is available
+    std::vector<int> published_clusters;
+    size_t published_count;
+
+    // worker state
+    std::vector<vec2f> centroids;
+
+    // rendering thread state: node id -> cluster (-1 if not clustered yet)
+    std::vector<int> clusters;
+    size_t cluster_count;
+
+    std::vector<vec2f> cluster_pos;
+    std::vector<int> cluster_size;
+
+    // per pair of clusters (a < b, at a * cluster_count + b)
+    std::vector<float> bundle_weight; // sum of |weight|
+    std::vector<float> bundle_sign; // sum of weight
+
+    void run();
+    void cluster(const std::vector<int>& ids, const std::vector<vec2f>& positions);
+
+    void buildBundle(RenderLayers& layers, const vec2f& p1, const vec2f& p2,
+                     float radius, const vec4f& col, bool shadow);
+
+public:
+    EdgeBundler();
+    ~EdgeBundler();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const {return enabled;}
+
+    size_t clusterCount() const {return cluster_count;}
+
+    /** Sends a snapshot of the layout to the clustering thread, at most
+     * every CLUSTERING_PERIOD.
+     */
+    void update(const Graph& g, float dt);
+
+    /** Starts a frame: picks up the latest clustering and computes the
+     * positions of the clusters.
+     */
+    void begin(const Graph& g);
+
+    /** Aggregates an edge into its bundle. Returns false if the edge can not
+     * be bundled (a node was not clustered yet): it must then be drawn
+     * individually.
+     */
+    bool add(const Edge& edge);
+
+    /** Adds the bundles of the frame to the edge layers
+     */
+    void build(RenderLayers& layers);
+};
+
+#endif // EDGE_BUNDLER_H
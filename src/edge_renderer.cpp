@@ -23,11 +23,13 @@
 
 using namespace std;
 
-EdgeRenderer::EdgeRenderer(int tagid, const string& label) :
+EdgeRenderer::EdgeRenderer(int tagid) :
+    idle_time(0.0),
     tagid(tagid),
-    label(label),
     label_pos(vec2f(0.0, 0.0)),
-    idle_time(0.0)
+    spline_dirty(true),
+    label(2),
+    label_dirty(true)
 {
 }
 
@@ -36,70 +38,83 @@ float EdgeRenderer::getAlpha() {
     return std::max(0.0f, FADE_TIME - idle_time)/FADE_TIME;
 }
 
-void EdgeRenderer::draw(rendering_mode mode, MemoryView& env) {
-    switch (mode) {
-    case NORMAL:
-        spline.draw();
-        break;
+void EdgeRenderer::build(RenderLayers& layers, MemoryView& env) {
 
-    case NAMES:
-        if (!label.empty()) drawName(env.font);
-        break;
+    bool near = env.lod == LOD_NEAR;
 
-    case SHADOWS:
-        spline.drawShadow();
-        break;
+    if (near && spline_dirty) {
+        spline = SplineEdge(pos1, col1,
+                            pos2, col2,
+                            spos,
+                            false, // arrow_head
+                            false); // arrow_tail
+        spline_dirty = false;
     }
 
+    if (layers.isEnabled(LAYER_EDGE_SHADOWS)) {
+        if (near) spline.build(layers, LAYER_EDGE_SHADOWS, true);
+        else buildStraight(layers, true);
+    }
+
+    if (near) spline.build(layers, LAYER_EDGES);
+    else buildStraight(layers, false);
+
+    if (layers.labelsEnabled() && !label.empty() && near) drawName(env);
+}
 
+void EdgeRenderer::setWeight(double weight) {
+    if (label.update(weight)) label_dirty = true;
 }
 
 void EdgeRenderer::update(vec2f pos1, vec4f col1, vec2f pos2, vec4f col2, vec2f spos){
 
     label_pos = pos1 + (pos2 - pos1) * 0.5;
 
-    vec2f projected_pos1  = display.project(vec3f(pos1.x, pos1.y, 0.0)).truncate();
-    vec2f projected_pos2  = display.project(vec3f(pos2.x, pos2.y, 0.0)).truncate();
-    vec2f projected_spos = display.project(vec3f(spos.x, spos.y, 0.0)).truncate();
-
-    spline = SplineEdge(projected_pos1, col1,
-                        projected_pos2, col2,
-                        spos,
-                        false, // arrow_head
-                        false); // arrow_tail
+    this->pos1 = display.project(vec3f(pos1.x, pos1.y, 0.0)).truncate();
+    this->pos2 = display.project(vec3f(pos2.x, pos2.y, 0.0)).truncate();
+    this->spos = spos;
+    this->col1 = col1;
+    this->col2 = col2;
 
+    spline_dirty = true;
 }
 
-void EdgeRenderer::increment_idle_time(float dt) {
-    if (selected) idle_time = 0.0;
-    else idle_time += dt;
-}
+void EdgeRenderer::buildStraight(RenderLayers& layers, bool shadow) {
 
-void EdgeRenderer::drawName(FXFont& font){
+    // same beam widths as SplineEdge
+    float radius = shadow ? 2.5 : 0.5;
 
-    glPushMatrix();
-    glTranslatef(label_pos.x, label_pos.y, 0.0);
+    vec2f p1 = pos1, p2 = pos2;
+    vec4f c1 = col1, c2 = col2;
 
-    glColor4f(1.0, 1.0, 1.0, getAlpha());
+    if (shadow) {
+        p1 += SHADOW_OFFSET;
+        p2 += SHADOW_OFFSET;
+        c1 = vec4f(0.0, 0.0, 0.0, SHADOW_STRENGTH * col1.w);
+        c2 = vec4f(0.0, 0.0, 0.0, SHADOW_STRENGTH * col2.w);
+    }
 
-    vec3f screenpos = display.project(vec3f(0.0, 0.0, 0.0));
+    vec2f perp = (p1 - p2).perpendicular().normal() * radius;
 
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    glOrtho(0, display.width, display.height, 0, -1.0, 1.0);
+    render_layer layer = shadow ? LAYER_EDGE_SHADOWS : LAYER_EDGES;
 
-    glMatrixMode(GL_MODELVIEW);
-    glPushMatrix();
-    glLoadIdentity();
+    layers.vertex(layer, p1 + perp, 1.0, 0.0, c1);
+    layers.vertex(layer, p1 - perp, 0.0, 0.0, c1);
+    layers.vertex(layer, p2 - perp, 0.0, 0.0, c2);
+    layers.vertex(layer, p2 + perp, 1.0, 0.0, c2);
+}
 
-    font.draw(screenpos.x, screenpos.y, label);
+void EdgeRenderer::increment_idle_time(float dt) {
+    if (selected) idle_time = 0.0;
+    else idle_time += dt;
+}
 
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
+void EdgeRenderer::drawName(MemoryView& env){
 
-    glMatrixMode(GL_MODELVIEW);
-    glPopMatrix();
+    if (label_dirty) {
+        env.labelfont.shape(label.c_str(), shaped_label);
+        label_dirty = false;
+    }
 
-    glPopMatrix();
+    env.labels.add(shaped_label, label_pos, BASE_FONT_SIZE, vec4f(1.0, 1.0, 1.0, getAlpha()));
 }
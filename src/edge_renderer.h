@@ -20,11 +20,14 @@
 #define EDGE_RENDERER_H
 
 #include "core/vectors.h"
+#include "core/glyphatlas.h"
 
 #include "constants.h"
 
 #include "styles.h"
 #include "spline.h"
+#include "fixed_label.h"
+#include "render_layers.h"
 
 class MemoryView;
 
@@ -36,12 +39,25 @@ class EdgeRenderer
 
     vec2f label_pos;
 
+    // extremities, control point and colours of the edge, as given by the
+    // last update()
+    vec2f pos1, pos2, spos;
+    vec4f col1, col2;
 
+    // the spline is only (re)computed when drawn at full level of details
     SplineEdge spline;
+    bool spline_dirty;
+
+    void buildStraight(RenderLayers& layers, bool shadow);
+
+    // the edge weight, with 2 decimals
+    FixedLabel label;
+    ShapedText shaped_label;
+    bool label_dirty;
 
     float getAlpha();
 
-    void drawName(FXFont& font);
+    void drawName(MemoryView& env);
 
 
 public:
@@ -49,13 +65,19 @@ public:
     // True if one of the two edge nodes is selected
     bool selected;
 
-    std::string label;
+    /**
+     * Updates the label with the edge weight. The label is only re-shaped
+     * when the displayed value changes.
+     */
+    void setWeight(double weight);
 
     void increment_idle_time(float dt);
 
-    EdgeRenderer(int tagid, const std::string& label = "");
+    EdgeRenderer(int tagid);
 
-    void draw(rendering_mode mode, MemoryView& env);
+    /** Adds the edge, its shadow and its label to the layers of the frame
+     */
+    void build(RenderLayers& layers, MemoryView& env);
 
     void update(vec2f pos1, vec4f col1, vec2f pos2, vec4f col2, vec2f spos);
 
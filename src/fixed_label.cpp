@@ -0,0 +1,79 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+
+#include "macros.h"
+#include "fixed_label.h"
+
+static const long long POWERS_OF_TEN[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+
+FixedLabel::FixedLabel(int decimals) :
+    decimals(CLAMP(decimals, 0, 6)),
+    quantized(0),
+    valid(false),
+    nan(false)
+{
+    text[0] = '\0';
+}
+
+bool FixedLabel::update(double value) {
+
+    if (std::isnan(value)) {
+        if (valid && nan) return false;
+
+        valid = true;
+        nan = true;
+        text[0] = '\0';
+        return true;
+    }
+
+    long long scale = POWERS_OF_TEN[decimals];
+    long long q = llround(CLAMP(value, -1e12, 1e12) * scale);
+
+    if (valid && !nan && q == quantized) return false;
+
+    valid = true;
+    nan = false;
+    quantized = q;
+
+    // digits are written backward, from the last decimal
+    char digits[MAX_LENGTH];
+    int n = 0;
+
+    unsigned long long magnitude = q < 0 ? -q : q;
+
+    for (int i = 0; i < decimals; i++) {
+        digits[n++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    }
+    if (decimals > 0) digits[n++] = '.';
+
+    do {
+        digits[n++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude > 0);
+
+    if (q < 0) digits[n++] = '-';
+
+    for (int i = 0; i < n; i++) {
+        text[i] = digits[n - 1 - i];
+    }
+    text[n] = '\0';
+
+    return true;
+}
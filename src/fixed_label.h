@@ -0,0 +1,52 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FIXED_LABEL_H
+#define FIXED_LABEL_H
+
+/**
+ * Text of a value printed in fixed notation with a given number of
+ * decimals (like 'fixed << setprecision(decimals)').
+ *
+ * The text lives in a small inline buffer and is only regenerated when
+ * the value, once quantized to the displayed precision, actually changes.
+ * NaN values are rendered as an empty string.
+ */
+class FixedLabel {
+
+    static const int MAX_LENGTH = 24;
+
+    char text[MAX_LENGTH];
+
+    int decimals;
+    long long quantized;
+    bool valid;
+    bool nan;
+
+public:
+    FixedLabel(int decimals);
+
+    /**
+     * Returns true if the text changed.
+     */
+    bool update(double value);
+
+    const char* c_str() const {return text;}
+    bool empty() const {return text[0] == '\0';}
+};
+
+#endif // FIXED_LABEL_H
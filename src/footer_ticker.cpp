@@ -0,0 +1,75 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+
+#include "core/display.h"
+
+#include "footer_ticker.h"
+
+using namespace std;
+
+FooterTicker::FooterTicker(int speed, int spacing) :
+    first(0),
+    scroll(0),
+    speed(speed),
+    spacing(spacing)
+{
+}
+
+void FooterTicker::queue(const string& text, FXFont& font, int screen_width) {
+
+    // starts just off screen, but does not overlap with previous text
+    int64_t x = scroll + screen_width + 10;
+
+    if (!entries.empty()) {
+        const Entry& last = entries.back();
+        x = max(x, last.x + last.width + spacing);
+    }
+
+    auto previous = latest.find(text);
+    if (previous != latest.end()) {
+        entries[previous->second - first].stale = true;
+    }
+
+    latest[text] = first + entries.size();
+
+    entries.push_back({text, x, (int) font.getWidth(text), false});
+}
+
+void FooterTicker::draw(FXFont& font, int y) {
+
+    // evicts what scrolled out of the screen
+    while (!entries.empty() && entries.front().x + entries.front().width < scroll) {
+        auto entry = latest.find(entries.front().text);
+        if (entry != latest.end() && entry->second == first) latest.erase(entry);
+
+        entries.pop_front();
+        first++;
+    }
+
+    for (const auto& entry : entries) {
+        int x = entry.x - scroll;
+
+        if (x > display.width) break;
+        if (entry.stale) continue;
+
+        font.print(x, y, "%s", entry.text.c_str());
+    }
+
+    scroll += speed;
+}
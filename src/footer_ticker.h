@@ -0,0 +1,75 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FOOTER_TICKER_H
+#define FOOTER_TICKER_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+#include "core/fxfont.h"
+
+/**
+ * Texts scrolling from right to left at the bottom of the screen.
+ *
+ * Entries are queued after the right edge of the last one, so the deque is
+ * always sorted by position: entries that left the screen are evicted from
+ * the front, and drawing stops at the first entry beyond the right side of
+ * the screen. Widths are measured once, when queued.
+ *
+ * Positions are stored relative to the scrolling offset, so that scrolling
+ * does not touch the entries.
+ *
+ * Queuing a text already in the ticker moves it to the end.
+ */
+class FooterTicker {
+
+    struct Entry {
+        std::string text;
+        int64_t x;
+        int width;
+        bool stale; // the text was queued again since
+    };
+
+    std::deque<Entry> entries;
+
+    // text -> index of its latest entry
+    std::unordered_map<std::string, uint64_t> latest;
+
+    // index of entries.front()
+    uint64_t first;
+
+    int64_t scroll;
+
+    int speed;
+    int spacing;
+
+public:
+    FooterTicker(int speed, int spacing = 50);
+
+    void queue(const std::string& text, FXFont& font, int screen_width);
+
+    /** Draws the visible entries at height y, then scrolls by one step.
+     */
+    void draw(FXFont& font, int y);
+
+    bool empty() const {return entries.empty();}
+};
+
+#endif // FOOTER_TICKER_H
@@ -0,0 +1,128 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "macros.h"
+#include "frame_scheduler.h"
+
+using namespace std;
+using namespace std::chrono;
+
+// a frame is considered over budget if its cost is more than the budget,
+// and under budget if it is less than UNDER_BUDGET_RATIO * budget
+static const float UNDER_BUDGET_RATIO = 0.6;
+// number of consecutive frames over budget before dropping one pass
+static const int DEGRADE_AFTER = 10;
+// number of consecutive frames under budget before restoring one pass
+static const int RESTORE_AFTER = 60;
+
+// we stop waiting slightly before the frame is due, so that we do not miss
+// the vertical sync
+static const auto VSYNC_MARGIN = milliseconds(1);
+
+// weight of the last frame in the smoothed stage durations
+static const float SMOOTHING = 0.1;
+
+FrameScheduler::FrameScheduler(float target_fps, bool adaptive) :
+    adaptive(adaptive),
+    degraded(0),
+    frames_over_budget(0),
+    frames_under_budget(0)
+{
+    setTargetFramerate(target_fps);
+
+    for (int i = 0; i < STAGE_COUNT; i++) stage_time[i] = 0.0;
+
+    frame_start = clock::now();
+}
+
+void FrameScheduler::setTargetFramerate(float fps) {
+    target_fps = max(0.0f, fps);
+
+    if (target_fps > 0) budget = duration_cast<clock::duration>(duration<float>(1.0 / target_fps));
+    else budget = clock::duration::zero();
+}
+
+void FrameScheduler::setAdaptive(bool adaptive) {
+    this->adaptive = adaptive;
+    if (!adaptive) degraded = 0;
+}
+
+float FrameScheduler::budgetTime() const {
+    return duration<float, milli>(budget).count();
+}
+
+void FrameScheduler::waitNextFrame(const function<void(float)>& service) {
+
+    auto due = frame_start + budget - VSYNC_MARGIN;
+
+    auto now = clock::now();
+
+    do {
+        float remaining = max(0.0f, duration<float, milli>(due - now).count());
+        service(remaining);
+        now = clock::now();
+    } while (now < due);
+
+    // if we are late by more than a whole frame, do not try to catch up
+    if (now - frame_start > 2 * budget) frame_start = now;
+    else frame_start = max(now, frame_start + budget);
+}
+
+void FrameScheduler::begin(frame_stage stage) {
+    stage_start[stage] = clock::now();
+}
+
+void FrameScheduler::end(frame_stage stage) {
+    float elapsed = duration<float, milli>(clock::now() - stage_start[stage]).count();
+
+    stage_time[stage] = stage_time[stage] * (1 - SMOOTHING) + elapsed * SMOOTHING;
+
+    // the draw stage closes the frame (the mouse trace happens during
+    // the draw)
+    if (stage == STAGE_DRAW) {
+        adaptQuality();
+    }
+}
+
+void FrameScheduler::adaptQuality() {
+
+    if (!adaptive || target_fps == 0) return;
+
+    float cost = stage_time[STAGE_LOGIC] + stage_time[STAGE_DRAW];
+    float budget_ms = budgetTime();
+
+    if (cost > budget_ms) {
+        frames_under_budget = 0;
+        if (++frames_over_budget >= DEGRADE_AFTER && degraded < PASS_COUNT) {
+            degraded++;
+            frames_over_budget = 0;
+            TRACE("Frame budget exceeded (" << cost << "ms): dropping one optional pass");
+        }
+    }
+    else if (cost < budget_ms * UNDER_BUDGET_RATIO) {
+        frames_over_budget = 0;
+        if (++frames_under_budget >= RESTORE_AFTER && degraded > 0) {
+            degraded--;
+            frames_under_budget = 0;
+            TRACE("Enough headroom in frame budget (" << cost << "ms): restoring one optional pass");
+        }
+    }
+    else {
+        frames_over_budget = 0;
+        frames_under_budget = 0;
+    }
+}
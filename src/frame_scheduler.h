@@ -0,0 +1,103 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include <chrono>
+#include <functional>
+
+enum frame_stage {STAGE_LOGIC, STAGE_TRACE, STAGE_DRAW, STAGE_COUNT};
+
+/** Optional rendering passes, in the order they are dropped when the frame
+ * budget is exceeded.
+ */
+enum optional_pass {PASS_BLOOM, PASS_SHADOWS, PASS_LABELS, PASS_COUNT};
+
+/**
+ * Paces the main loop at a target frame rate.
+ *
+ * Each frame measures the cost of its stages (logic, mouse trace, draw).
+ * Instead of sleeping a fixed amount of time, waitNextFrame() only waits for
+ * what remains of the frame budget, and hands that time over to a 'service'
+ * function (typically, processing incoming ROS messages).
+ *
+ * When the cost of the frames consistently exceeds the budget, optional
+ * passes are progressively disabled (bloom first, then shadows, then
+ * labels), and restored once there is enough headroom again.
+ */
+class FrameScheduler {
+
+    typedef std::chrono::steady_clock clock;
+
+    float target_fps;
+    clock::duration budget;
+
+    clock::time_point frame_start;
+    clock::time_point stage_start[STAGE_COUNT];
+
+    // smoothed duration of each stage, in ms
+    float stage_time[STAGE_COUNT];
+
+    bool adaptive;
+
+    // number of optional passes currently disabled
+    int degraded;
+
+    int frames_over_budget;
+    int frames_under_budget;
+
+    void adaptQuality();
+
+public:
+    FrameScheduler(float target_fps = 60.0, bool adaptive = true);
+
+    /** Sets the target frame rate. 0 means 'as fast as possible'.
+     */
+    void setTargetFramerate(float fps);
+    float getTargetFramerate() const {return target_fps;}
+
+    void setAdaptive(bool adaptive);
+
+    /**
+     * Waits until the next frame is due. While waiting, 'service' is
+     * repeatedly called with the remaining time (in ms), and is expected to
+     * return no later than that. It is called at least once, possibly with
+     * a remaining time of 0.
+     */
+    void waitNextFrame(const std::function<void(float)>& service);
+
+    void begin(frame_stage stage);
+    void end(frame_stage stage);
+
+    /** Smoothed duration of a stage, in ms
+     */
+    float stageTime(frame_stage stage) const {return stage_time[stage];}
+
+    /** Frame budget, in ms
+     */
+    float budgetTime() const;
+
+    /** Returns false if this optional pass is currently disabled to keep
+     * within the frame budget.
+     */
+    bool allow(optional_pass pass) const {return pass >= degraded;}
+
+    int degradedPasses() const {return degraded;}
+};
+
+#endif // FRAME_SCHEDULER_H
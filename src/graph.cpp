@@ -37,32 +37,56 @@ Graph::Graph()
 }
 
 
-void Graph::step(float dt) {
+float Graph::step(float dt) {
 
     for(auto& e : edges) {
         e.step(*this, dt);
     }
 
+    float motion = 0.0;
+
     for(auto& n : nodes) {
 
+        vec2f previous = n.second.pos;
         n.second.step(*this, dt);
+        motion = max(motion, (n.second.pos - previous).length());
     }
+
+    return motion;
 }
 
-void Graph::render(rendering_mode mode, MemoryView& env, bool debug) {
+void Graph::build(RenderLayers& layers, MemoryView& env) {
+
+    bool bundled = env.bundler.isEnabled();
+
+    if (bundled) env.bundler.begin(*this);
 
-    // Renders edges
     for(auto& e : edges) {
-        e.render(mode, env);
+        // when bundled, only the edges of the hovered and selected nodes
+        // are drawn individually
+        if (bundled && !e.highlighted() && env.bundler.add(e)) continue;
+
+        e.build(layers, env);
     }
 
-    // Renders nodes
+    if (bundled) env.bundler.build(layers);
+
     for(auto& n : nodes) {
-        n.second.render(mode, env, debug);
+        n.second.build(layers, env);
     }
 
 }
 
+void Graph::drawForces() {
+
+    for(auto& n : nodes) {
+        const Node& node = n.second;
+
+        MemoryView::drawVector(node.hookeForce, node.pos, vec4f(1.0, 0.2, 0.2, 0.7));
+        MemoryView::drawVector(node.coulombForce, node.pos, vec4f(0.2, 1.0, 0.2, 0.7));
+    }
+}
+
 const Graph::NodeMap& Graph::getNodes() const {
     return nodes;
 }
@@ -130,6 +154,10 @@ Node* Graph::getHovered() {
 }
 
 
+void Graph::reserve(size_t units) {
+    if (units > 1) edges.reserve(units * (units - 1) / 2);
+}
+
 Node& Graph::addNode(int id, const string& label, const Node* neighbour) {
 
     pair<NodeMap::iterator, bool> res;
@@ -357,12 +385,12 @@ void Graph::saveToGraphViz(MemoryView& env) {
 
     // Renders edges
     for(auto& e : edges) {
-        e.render(GRAPHVIZ, env);
+        e.toGraphViz(env);
     }
 
     // Renders nodes
     for(auto& n : nodes) {
-        n.second.render(GRAPHVIZ, env, false);
+        n.second.toGraphViz(env);
     }
 
     env.graphvizGraph << "}\n";
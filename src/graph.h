@@ -53,15 +53,25 @@ private:
 public:
     Graph();
 
-    void step(float dt);
+    /** Allocates the edges of a graph of 'units' nodes up front, so that
+     * adding nodes does not reallocate them
+     */
+    void reserve(size_t units);
+
+    /** Steps the layout. Returns the largest displacement of a node.
+     */
+    float step(float dt);
 
     /**
-      Renders the graph. If called with argument 'false', goes in simple mode.
+      Fills the layers of the frame with the edges, then the nodes, in a
+      single traversal of the graph.
+      */
+    void build(RenderLayers& layers, MemoryView& env);
 
-      In simple mode, neither edges or special effects are rendered. Useful for picking selected
-      primitive in OpenGL GL_SELECT mode.
+    /**
+      Draws the Hooke and Coulomb forces applying on each node.
       */
-    void render(rendering_mode mode, MemoryView& env, bool debug = false);
+    void drawForces();
 
     /**
       Returns an immutable reference to the list of nodes.
@@ -0,0 +1,387 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/shader.h"
+
+#include "macros.h"
+#include "styles.h"
+#include "heatmap_view.h"
+
+using namespace std;
+
+// the weights are read at most every HEATMAP_UPDATE_PERIOD seconds (plus
+// whenever units are added)
+static const float HEATMAP_UPDATE_PERIOD = 0.1;
+// rows and columns are re-ordered every SERIATION_PERIOD seconds
+static const float SERIATION_PERIOD = 10.0;
+// changes of weight smaller than that are not visible (8 bits colours)
+static const float WEIGHT_EPSILON = 1.0 / 512;
+
+constexpr float HeatmapView::SIZE;
+
+#ifdef SDLAPP_SHADER_SUPPORT
+// looks the weights up in WEIGHT_COLOURS, uploaded as a 1D texture: the
+// texel picked is the entry ColourLUT::index() would return
+static const char* COLOURMAP_SHADER =
+    "uniform sampler2D weights;\n"
+    "uniform sampler1D colours;\n"
+    "void main() {\n"
+    "    float w = clamp(texture2D(weights, gl_TexCoord[0].xy).r, -1.0, 1.0);\n"
+    "    float x = ((w + 1.0) * 127.5 + 0.5) / 256.0;\n"
+    "    gl_FragColor = vec4(texture1D(colours, x).rgb, 1.0);\n"
+    "}\n";
+#endif
+
+HeatmapView::HeatmapView() :
+    n(0),
+    max_units(0),
+    limited(false),
+    texture(0),
+    colours_texture(0),
+    texture_size(0),
+    allocated_size(0),
+    reserved_size(1),
+    float_texture(false),
+    colourmap_program(0),
+    since_update(HEATMAP_UPDATE_PERIOD),
+    since_seriation(0.0)
+{
+}
+
+HeatmapView::~HeatmapView() {
+    if (texture) glDeleteTextures(1, &texture);
+    if (colours_texture) glDeleteTextures(1, &colours_texture);
+
+#ifdef SDLAPP_SHADER_SUPPORT
+    if (colourmap_program) glDeleteProgram(colourmap_program);
+#endif
+}
+
+void HeatmapView::init() {
+
+    GLint max_size;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+    max_units = max_size;
+
+#ifdef SDLAPP_SHADER_SUPPORT
+    if (gShadersEnabled && GLEW_VERSION_2_0 && GLEW_ARB_texture_float) {
+        colourmap_program = createFragmentProgram(COLOURMAP_SHADER);
+        float_texture = colourmap_program != 0;
+    }
+
+    if (float_texture) uploadColourMap();
+#endif
+
+    if (!float_texture) {
+        debugLog("float textures or shaders not supported: the heatmap colours are computed on the CPU\n");
+    }
+}
+
+void HeatmapView::reserve(size_t units) {
+
+    units = min(units, max_units);
+
+    mirror.reserve(units * units);
+    dirty.reserve(units);
+    order.reserve(units);
+    position.reserve(units);
+
+    while (reserved_size < (int) units) reserved_size *= 2;
+}
+
+void HeatmapView::colourMap(float weight, unsigned char* rgba) {
+
+    const vec4f& col = WEIGHT_COLOURS(weight);
+
+    rgba[0] = (unsigned char) (col.x * 255);
+    rgba[1] = (unsigned char) (col.y * 255);
+    rgba[2] = (unsigned char) (col.z * 255);
+    rgba[3] = 255;
+}
+
+void HeatmapView::uploadColourMap() {
+
+    // the heatmap is opaque: only the rgb of the LUT is used
+    unsigned char rgba[ColourLUT::SIZE * 4];
+    for (int i = 0; i < ColourLUT::SIZE; i++) {
+        const vec4f& col = WEIGHT_COLOURS.data()[i];
+
+        rgba[i * 4]     = (unsigned char) (col.x * 255);
+        rgba[i * 4 + 1] = (unsigned char) (col.y * 255);
+        rgba[i * 4 + 2] = (unsigned char) (col.z * 255);
+        rgba[i * 4 + 3] = 255;
+    }
+
+    if (!colours_texture) glGenTextures(1, &colours_texture);
+
+    glBindTexture(GL_TEXTURE_1D, colours_texture);
+
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+
+    glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA8, ColourLUT::SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+}
+
+void HeatmapView::resize(size_t size) {
+
+    n = size;
+
+    texture_size = reserved_size;
+    while (texture_size < (int) n) texture_size *= 2;
+
+    order.resize(n);
+    position.resize(n);
+    for (size_t i = 0; i < n; i++) order[i] = position[i] = i;
+
+    mirror.assign(n * n, 0.0f);
+    dirty.assign(n, true);
+}
+
+void HeatmapView::seriate(const MemoryMatrix& weights) {
+
+    // Greedy seriation: starts from the unit with the strongest associations,
+    // then repeatedly appends the unit the most associated to the last one.
+
+    auto weight = [&weights](size_t i, size_t j) {
+        double w = weights(i, j) + weights(j, i);
+        return std::isnan(w) ? 0.0 : w;
+    };
+
+    vector<size_t> new_order;
+    new_order.reserve(n);
+
+    vector<bool> placed(n, false);
+
+    size_t current = 0;
+    double strongest = -1.0;
+
+    for (size_t i = 0; i < n; i++) {
+        double total = 0.0;
+        for (size_t j = 0; j < n; j++) {
+            if (i != j) total += fabs(weight(i, j));
+        }
+        if (total > strongest) {
+            strongest = total;
+            current = i;
+        }
+    }
+
+    while (true) {
+        new_order.push_back(current);
+        placed[current] = true;
+
+        if (new_order.size() == n) break;
+
+        size_t next = n;
+        double best = 0.0;
+
+        for (size_t j = 0; j < n; j++) {
+            if (placed[j]) continue;
+
+            double w = weight(current, j);
+            if (next == n || w > best) {
+                next = j;
+                best = w;
+            }
+        }
+
+        current = next;
+    }
+
+    if (new_order == order) return;
+
+    order.swap(new_order);
+
+    for (size_t k = 0; k < n; k++) position[order[k]] = k;
+
+    dirty.assign(n, true);
+}
+
+void HeatmapView::update(const MemoryNetwork& memory, float dt) {
+
+    since_update += dt;
+    since_seriation += dt;
+
+    size_t size = memory.size();
+
+    // clamped before comparing with n: past the limit, the heatmap is not
+    // rebuilt every frame
+    if (size > max_units) {
+        if (!limited) {
+            debugLog("heatmap limited to the first %lu units (maximum texture size)\n", (unsigned long) max_units);
+            limited = true;
+        }
+        size = max_units;
+    }
+
+    if (size == 0) return;
+    if (since_update < HEATMAP_UPDATE_PERIOD && size == n) return;
+
+    since_update = 0.0;
+
+    MemoryMatrix weights = memory.weights();
+
+    size = min(size, (size_t) weights.rows());
+
+    if (size != n) {
+        names = memory.units_names();
+        resize(size);
+        seriate(weights);
+        since_seriation = 0.0;
+    }
+    else if (since_seriation > SERIATION_PERIOD) {
+        seriate(weights);
+        since_seriation = 0.0;
+    }
+
+    for (size_t r = 0; r < n; r++) {
+        float* row = &mirror[r * n];
+        size_t i = order[r];
+
+        for (size_t c = 0; c < n; c++) {
+            float w = weights(i, order[c]);
+            if (std::isnan(w)) w = 0.0f;
+
+            if (fabs(w - row[c]) > WEIGHT_EPSILON) {
+                row[c] = w;
+                dirty[r] = true;
+            }
+        }
+    }
+}
+
+void HeatmapView::upload() {
+
+    if (!texture) glGenTextures(1, &texture);
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    if (allocated_size != texture_size) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        // only the n x n corner of the texture is ever used
+#ifdef SDLAPP_SHADER_SUPPORT
+        if (float_texture) {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE32F_ARB, texture_size, texture_size, 0, GL_LUMINANCE, GL_FLOAT, 0);
+        }
+        else
+#endif
+        {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, texture_size, texture_size, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+        }
+
+        allocated_size = texture_size;
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // consecutive dirty rows are uploaded together
+    size_t r = 0;
+    while (r < n) {
+        if (!dirty[r]) {
+            r++;
+            continue;
+        }
+
+        size_t first = r;
+        while (r < n && dirty[r]) dirty[r++] = false;
+        size_t rows = r - first;
+
+        if (float_texture) {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, first, n, rows, GL_LUMINANCE, GL_FLOAT, &mirror[first * n]);
+        }
+        else {
+            rgba_row.resize(rows * n * 4);
+            for (size_t k = 0; k < rows * n; k++) {
+                colourMap(mirror[first * n + k], &rgba_row[k * 4]);
+            }
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, first, n, rows, GL_RGBA, GL_UNSIGNED_BYTE, &rgba_row[0]);
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void HeatmapView::draw() {
+
+    if (n == 0) return;
+
+    glEnable(GL_TEXTURE_2D);
+
+    upload();
+
+    float extent = n / (float) texture_size;
+    float half = SIZE / 2;
+
+#ifdef SDLAPP_SHADER_SUPPORT
+    if (float_texture) {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_1D, colours_texture);
+        glActiveTexture(GL_TEXTURE0);
+
+        glUseProgram(colourmap_program);
+        glUniform1i(glGetUniformLocation(colourmap_program, "weights"), 0);
+        glUniform1i(glGetUniformLocation(colourmap_program, "colours"), 1);
+    }
+#endif
+
+    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+
+    glBegin(GL_QUADS);
+    glTexCoord2f(0.0f, 0.0f);
+    glVertex2f(-half, -half);
+    glTexCoord2f(extent, 0.0f);
+    glVertex2f(half, -half);
+    glTexCoord2f(extent, extent);
+    glVertex2f(half, half);
+    glTexCoord2f(0.0f, extent);
+    glVertex2f(-half, half);
+    glEnd();
+
+#ifdef SDLAPP_SHADER_SUPPORT
+    if (float_texture) glUseProgram(0);
+#endif
+}
+
+bool HeatmapView::cellAt(const vec2f& screenpos, size_t& row_unit, size_t& column_unit) const {
+
+    if (n == 0) return false;
+
+    vec2f pos;
+    if (!display.unprojectOnPlane(screenpos, pos)) return false;
+
+    float column = (pos.x + SIZE / 2) / SIZE * n;
+    float row = (pos.y + SIZE / 2) / SIZE * n;
+
+    if (column < 0 || row < 0 || column >= n || row >= n) return false;
+
+    row_unit = order[(size_t) row];
+    column_unit = order[(size_t) column];
+
+    return true;
+}
+
+float HeatmapView::getWeight(size_t row_unit, size_t column_unit) const {
+    return mirror[position[row_unit] * n + position[column_unit]];
+}
@@ -0,0 +1,127 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HEATMAP_VIEW_H
+#define HEATMAP_VIEW_H
+
+#include <string>
+#include <vector>
+
+#include "core/display.h"
+#include "core/vectors.h"
+
+#include "AssociativeMemory/memory_network.hpp"
+
+/**
+ * Alternative view of the memory: the weight matrix, drawn as a colour-mapped
+ * adjacency heatmap (same colours as the edges, from WEIGHT_COLOURS: orange
+ * for positive weights, blue for negative ones).
+ *
+ * The weights are stored in a texture, with one texel per pair of units.
+ * When shaders are available, the texture holds the raw weights (float
+ * texture) and the colour map is applied by a fragment shader, which looks
+ * WEIGHT_COLOURS up in a 1D texture; otherwise weights are colour-mapped on
+ * the CPU, into an RGBA texture.
+ *
+ * Only the rows that changed since the last upload are sent to the GPU.
+ *
+ * Rows and columns are ordered by a greedy seriation of the weight matrix,
+ * so that strongly associated units end up next to each other. The order is
+ * recomputed when units are added, and periodically.
+ *
+ * The heatmap is drawn in the graph plane (z = 0), centred on the origin,
+ * so that it can be zoomed and panned with the usual camera.
+ */
+class HeatmapView {
+
+    size_t n;
+    // GL_MAX_TEXTURE_SIZE: units past that are not shown
+    size_t max_units;
+    bool limited;
+
+    // display row/column -> unit index, and unit index -> display row/column
+    std::vector<size_t> order;
+    std::vector<size_t> position;
+    std::vector<std::string> names;
+
+    // weights currently in the texture, in display order (row-major)
+    std::vector<float> mirror;
+    std::vector<bool> dirty;
+
+    std::vector<unsigned char> rgba_row;
+
+    GLuint texture;
+    // WEIGHT_COLOURS, for the shader
+    GLuint colours_texture;
+    int texture_size;
+    int allocated_size;
+    // the texture is never smaller than that (see reserve())
+    int reserved_size;
+
+    bool float_texture;
+    GLuint colourmap_program;
+
+    float since_update;
+    float since_seriation;
+
+    void seriate(const MemoryMatrix& weights);
+    void resize(size_t size);
+    void upload();
+    void uploadColourMap();
+
+    static void colourMap(float weight, unsigned char* rgba);
+
+public:
+    HeatmapView();
+    ~HeatmapView();
+
+    /** Side of the heatmap, in world units
+     */
+    static constexpr float SIZE = 500.0f;
+
+    /** Chooses between float texture + shader and the CPU colour map, and
+     * reads the maximum texture size. Needs a GL context, and must be
+     * called before reserve() and update().
+     */
+    void init();
+
+    /** Allocates the mirror and the texture for 'units' units up front, so
+     * that adding units does not reallocate them
+     */
+    void reserve(size_t units);
+
+    /** Reads the weights of the network (at most every HEATMAP_UPDATE_PERIOD)
+     * and marks the rows that changed.
+     */
+    void update(const MemoryNetwork& memory, float dt);
+
+    void draw();
+
+    /** Returns the units (row and column) of the cell under a screen
+     * position, using the current matrices. Returns false if there is no
+     * cell there.
+     */
+    bool cellAt(const vec2f& screenpos, size_t& row_unit, size_t& column_unit) const;
+
+    const std::string& getName(size_t unit) const {return names[unit];}
+
+    /** Last weight read between two units
+     */
+    float getWeight(size_t row_unit, size_t column_unit) const;
+};
+
+#endif // HEATMAP_VIEW_H
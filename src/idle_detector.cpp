@@ -0,0 +1,91 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "idle_detector.h"
+
+using namespace std;
+
+// the network is compared to its snapshot at most every NETWORK_CHECK_PERIOD
+// seconds
+static const float NETWORK_CHECK_PERIOD = 0.1;
+// how long nothing must change before the scene is considered idle (lets the
+// camera and the fading labels settle)
+static const float IDLE_DELAY = 1.0;
+
+IdleDetector::IdleDetector() :
+    enabled(false),
+    quiet_time(0.0),
+    since_network_check(NETWORK_CHECK_PERIOD),
+    activation_threshold(0.01),
+    weight_threshold(0.01),
+    position_threshold(0.05),
+    camera_threshold(0.05)
+{
+}
+
+void IdleDetector::setEnabled(bool enabled) {
+    this->enabled = enabled;
+    wake();
+}
+
+bool IdleDetector::isIdle() const {
+    return enabled && quiet_time > IDLE_DELAY;
+}
+
+void IdleDetector::frameDrawn(float dt, float layout_motion, const vec3f& camera, bool animating) {
+
+    if (!enabled) return;
+
+    if (animating
+        || layout_motion > position_threshold
+        || (camera - camera_pos).length() > camera_threshold) {
+        wake();
+    }
+    else {
+        quiet_time += dt;
+    }
+
+    camera_pos = camera;
+}
+
+void IdleDetector::checkNetwork(const MemoryNetwork& memory, float dt) {
+
+    if (!enabled) return;
+
+    since_network_check += dt;
+    if (since_network_check < NETWORK_CHECK_PERIOD) return;
+    since_network_check = 0.0;
+
+    auto new_activations = memory.activations();
+    auto new_weights = memory.weights();
+
+    bool changed = new_activations.size() != activations.size()
+                || new_weights.rows() != weights.rows()
+                || new_weights.cols() != weights.cols();
+
+    if (!changed && activations.size() > 0) {
+        // NaN never compares greater: a NaN appearing does not wake up the view
+        changed = (new_activations - activations).cwiseAbs().maxCoeff() > activation_threshold
+               || (new_weights - weights).cwiseAbs().maxCoeff() > weight_threshold;
+    }
+
+    if (changed) {
+        wake();
+        activations.swap(new_activations);
+        weights.swap(new_weights);
+    }
+}
@@ -0,0 +1,81 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef IDLE_DETECTOR_H
+#define IDLE_DETECTOR_H
+
+#include "core/vectors.h"
+
+#include "AssociativeMemory/memory_network.hpp"
+
+/**
+ * Decides when the scene is static, so that the main loop can stop
+ * redrawing the same picture.
+ *
+ * The scene is considered idle once nothing visible changed for a short
+ * while: the layout is asleep, the camera does not move, no input was
+ * received and neither the activations nor the weights of the network
+ * changed by more than their thresholds.
+ *
+ * The network does not notify its changes: it is compared to a snapshot,
+ * at most every NETWORK_CHECK_PERIOD seconds, whether or not frames are
+ * drawn.
+ */
+class IdleDetector {
+
+    bool enabled;
+
+    // time since the last visible change, in seconds
+    float quiet_time;
+
+    float since_network_check;
+    MemoryVector activations;
+    MemoryMatrix weights;
+
+    vec3f camera_pos;
+
+public:
+    IdleDetector();
+
+    // maximum changes that are considered invisible
+    float activation_threshold;
+    float weight_threshold;
+    float position_threshold; // world units, per frame
+    float camera_threshold; // world units, per frame
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const {return enabled;}
+
+    /** Forces the next frames to be drawn (input, incoming messages...)
+     */
+    void wake() {quiet_time = 0.0;}
+
+    bool isIdle() const;
+
+    /** To be called after each drawn frame, with the largest displacement of
+     * a node during that frame. 'animating' is true if something else is
+     * still moving on screen.
+     */
+    void frameDrawn(float dt, float layout_motion, const vec3f& camera, bool animating);
+
+    /** Compares the network to the last snapshot (throttled), and wakes up
+     * the detector if it changed.
+     */
+    void checkNetwork(const MemoryNetwork& memory, float dt);
+};
+
+#endif // IDLE_DETECTOR_H
@@ -0,0 +1,277 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+#include "latency.h"
+
+using namespace std;
+
+// receipts waiting for a frame are not kept beyond this (eg, without viewer)
+static const size_t MAX_PENDING_RECEIPTS = 1 << 16;
+
+const int LatencyHistogram::SUB_BITS;
+const uint64_t LatencyHistogram::SUB_BUCKETS;
+const int LatencyHistogram::MAX_BITS;
+
+LatencyHistogram::LatencyHistogram() :
+    counts((MAX_BITS - SUB_BITS + 1) * SUB_BUCKETS, 0),
+    total(0),
+    sum(0),
+    max_value(0)
+{
+}
+
+size_t LatencyHistogram::index(uint64_t value) {
+
+    if (value < SUB_BUCKETS) return value;
+
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - SUB_BITS;
+
+    return (shift + 1) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS);
+}
+
+uint64_t LatencyHistogram::value(size_t index) {
+
+    if (index < SUB_BUCKETS) return index;
+
+    int shift = index / SUB_BUCKETS - 1;
+    uint64_t lowest = (index % SUB_BUCKETS + SUB_BUCKETS) << shift;
+
+    // middle of the bucket
+    return lowest + (((uint64_t) 1 << shift) >> 1);
+}
+
+void LatencyHistogram::record(uint64_t us) {
+
+    us = min(us, ((uint64_t) 1 << MAX_BITS) - 1);
+
+    counts[index(us)]++;
+
+    total++;
+    sum += us;
+    max_value = std::max(max_value, us);
+}
+
+void LatencyHistogram::clear() {
+    fill(counts.begin(), counts.end(), 0);
+    total = sum = max_value = 0;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+
+    if (total == 0) return 0;
+
+    uint64_t rank = std::max((uint64_t) 1, (uint64_t) ceil(p * total));
+    uint64_t seen = 0;
+
+    for (size_t i = 0; i < counts.size(); i++) {
+        seen += counts[i];
+        if (seen >= rank) return min(value(i), max_value);
+    }
+
+    return max_value;
+}
+
+Json::Value LatencyHistogram::toJson() const {
+
+    Json::Value json;
+
+    json["count"] = (Json::UInt64) total;
+    json["mean_us"] = mean();
+    json["p50_us"] = (Json::UInt64) percentile(0.5);
+    json["p90_us"] = (Json::UInt64) percentile(0.9);
+    json["p99_us"] = (Json::UInt64) percentile(0.99);
+    json["p999_us"] = (Json::UInt64) percentile(0.999);
+    json["max_us"] = (Json::UInt64) max_value;
+
+    return json;
+}
+
+LatencyTracker::LatencyTracker() :
+    dump_period(0.0),
+    dumping(false)
+{
+    for (int i = 0; i < LATENCY_STAGE_COUNT; i++) enabled[i] = true;
+
+    enabled[LATENCY_PUBLICATION] = false;
+    enabled[LATENCY_DISPLAY] = false;
+}
+
+LatencyTracker::~LatencyTracker() {
+    stopDump();
+}
+
+void LatencyTracker::enable(latency_stage stage) {
+    lock_guard<std::mutex> lock(mutex);
+    enabled[stage] = true;
+}
+
+void LatencyTracker::record(latency_stage stage, const Clock::time_point& receipt, const Clock::time_point& now) {
+
+    uint64_t us = chrono::duration_cast<chrono::microseconds>(now - receipt).count();
+
+    histograms[stage].record(us);
+    period_histograms[stage].record(us);
+}
+
+static void keep(vector<LatencyTracker::Clock::time_point>& pending,
+                 const vector<LatencyTracker::Clock::time_point>& receipts) {
+
+    size_t room = MAX_PENDING_RECEIPTS - min(MAX_PENDING_RECEIPTS, pending.size());
+    pending.insert(pending.end(), receipts.begin(), receipts.begin() + min(room, receipts.size()));
+}
+
+void LatencyTracker::activated(const vector<Clock::time_point>& receipts,
+                               const vector<uint64_t>& transport_us) {
+
+    auto now = Clock::now();
+
+    lock_guard<std::mutex> lock(mutex);
+
+    for (auto us : transport_us) {
+        histograms[LATENCY_TRANSPORT].record(us);
+        period_histograms[LATENCY_TRANSPORT].record(us);
+    }
+
+    for (const auto& receipt : receipts) record(LATENCY_ACTIVATION, receipt, now);
+
+    if (enabled[LATENCY_PUBLICATION]) keep(unpublished_receipts, receipts);
+    if (enabled[LATENCY_DISPLAY]) keep(activated_receipts, receipts);
+}
+
+void LatencyTracker::published(bool sent) {
+
+    auto now = Clock::now();
+
+    lock_guard<std::mutex> lock(mutex);
+
+    if (sent) {
+        for (const auto& receipt : unpublished_receipts) record(LATENCY_PUBLICATION, receipt, now);
+    }
+    unpublished_receipts.clear();
+}
+
+void LatencyTracker::frameStarted() {
+
+    lock_guard<std::mutex> lock(mutex);
+
+    frame_receipts.insert(frame_receipts.end(), activated_receipts.begin(), activated_receipts.end());
+    activated_receipts.clear();
+}
+
+void LatencyTracker::frameShown() {
+
+    auto now = Clock::now();
+
+    lock_guard<std::mutex> lock(mutex);
+
+    for (const auto& receipt : frame_receipts) record(LATENCY_DISPLAY, receipt, now);
+    frame_receipts.clear();
+}
+
+LatencyHistogram LatencyTracker::histogram(latency_stage stage) const {
+    lock_guard<std::mutex> lock(mutex);
+    return histograms[stage];
+}
+
+LatencyTracker::Summary LatencyTracker::summary(latency_stage stage) const {
+
+    lock_guard<std::mutex> lock(mutex);
+
+    const LatencyHistogram& histogram = histograms[stage];
+
+    return {histogram.count(), histogram.percentile(0.5), histogram.percentile(0.99), histogram.max()};
+}
+
+Json::Value LatencyTracker::toJson() const {
+
+    Json::Value json;
+
+    lock_guard<std::mutex> lock(mutex);
+
+    for (int i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        if (enabled[i]) json[stageName((latency_stage) i)] = histograms[i].toJson();
+    }
+
+    return json;
+}
+
+void LatencyTracker::startDump(const string& path, double period) {
+
+    if (dump_thread.joinable() || period <= 0.0) return;
+
+    dump_path = path;
+    dump_period = period;
+    dumping = true;
+
+    dump_thread = std::thread([this]() {
+        unique_lock<std::mutex> lock(mutex);
+        while (!stopping.wait_for(lock, chrono::duration<double>(dump_period), [this]{return !dumping;})) {
+            Json::Value json = periodJson();
+
+            // the file is written without blocking the ingestion
+            lock.unlock();
+            ofstream file(dump_path, ofstream::app);
+            file << Json::FastWriter().write(json);
+            lock.lock();
+        }
+    });
+}
+
+void LatencyTracker::stopDump() {
+
+    if (!dump_thread.joinable()) return;
+
+    {
+        lock_guard<std::mutex> lock(mutex);
+        dumping = false;
+    }
+    stopping.notify_all();
+
+    dump_thread.join();
+}
+
+Json::Value LatencyTracker::periodJson() {
+
+    // called with the mutex locked
+    Json::Value json;
+
+    json["time"] = (Json::UInt64) chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count();
+    json["period_s"] = dump_period;
+
+    for (int i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        if (!enabled[i]) continue;
+        json[stageName((latency_stage) i)] = period_histograms[i].toJson();
+        period_histograms[i].clear();
+    }
+
+    return json;
+}
+
+const char* LatencyTracker::stageName(latency_stage stage) {
+    switch (stage) {
+        case LATENCY_TRANSPORT: return "transport";
+        case LATENCY_ACTIVATION: return "activation";
+        case LATENCY_PUBLICATION: return "publication";
+        case LATENCY_DISPLAY: return "display";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,175 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <json/json.h>
+
+/**
+ * Histogram of latencies, in microseconds, with a bounded relative error
+ * (HDR histogram): each power of two is split in SUB_BUCKETS linear
+ * buckets. Recording is O(1), and the memory does not depend on the number
+ * of samples.
+ */
+class LatencyHistogram {
+
+    static const int SUB_BITS = 7;
+    static const uint64_t SUB_BUCKETS = 1 << SUB_BITS;
+    // values above 2^MAX_BITS us (about 12 days) are clamped
+    static const int MAX_BITS = 40;
+
+    std::vector<uint64_t> counts;
+
+    uint64_t total;
+    uint64_t sum;
+    uint64_t max_value;
+
+    static size_t index(uint64_t value);
+    static uint64_t value(size_t index);
+
+public:
+    LatencyHistogram();
+
+    void record(uint64_t us);
+    void clear();
+
+    uint64_t count() const {return total;}
+    uint64_t max() const {return max_value;}
+    double mean() const {return total ? (double) sum / total : 0.0;}
+
+    /** Value (in us) under which a fraction 'p' of the samples are
+     */
+    uint64_t percentile(double p) const;
+
+    /** count, mean, p50, p90, p99, p999 and max, in microseconds
+     */
+    Json::Value toJson() const;
+};
+
+enum latency_stage {
+    // send stamp of the message (header.stamp) -> receipt. Needs the clocks
+    // of the sender and of the receiver to be synchronized.
+    LATENCY_TRANSPORT,
+    // receipt -> activation of the units
+    LATENCY_ACTIVATION,
+    // receipt -> first publication of the state of the network after the
+    // activation
+    LATENCY_PUBLICATION,
+    // receipt -> end of the first frame drawn after the activation
+    LATENCY_DISPLAY,
+    LATENCY_STAGE_COUNT
+};
+
+/**
+ * Latencies of the attention messages, from their sending to their display.
+ *
+ * The ingestion thread reports the receipts of the messages it activated,
+ * in one call per window; the state publisher reports each publication;
+ * the viewer reports the beginning of each frame (when it reads the
+ * network) and its end. The publication and display stages are only
+ * tracked once enabled, by the publisher and the viewer.
+ *
+ * Each stage has a cumulated histogram, and one for the current dump
+ * period: if dumps are enabled, a JSON line with the latter is appended to
+ * a file every period.
+ */
+class LatencyTracker {
+
+public:
+    typedef std::chrono::steady_clock Clock;
+
+private:
+    mutable std::mutex mutex;
+
+    bool enabled[LATENCY_STAGE_COUNT];
+
+    LatencyHistogram histograms[LATENCY_STAGE_COUNT];
+    LatencyHistogram period_histograms[LATENCY_STAGE_COUNT];
+
+    // receipts of the activated messages, not published yet
+    std::vector<Clock::time_point> unpublished_receipts;
+    // receipts of the activated messages, not read by a frame yet
+    std::vector<Clock::time_point> activated_receipts;
+    // receipts of the messages read by the current frame
+    std::vector<Clock::time_point> frame_receipts;
+
+    std::string dump_path;
+    double dump_period;
+    std::thread dump_thread;
+    std::condition_variable stopping;
+    bool dumping;
+
+    void record(latency_stage stage, const Clock::time_point& receipt, const Clock::time_point& now);
+    // latencies since the previous dump (and resets them)
+    Json::Value periodJson();
+
+public:
+    LatencyTracker();
+    ~LatencyTracker();
+
+    void enable(latency_stage stage);
+
+    /** Called by the ingestion thread after activating units: receipts of
+     * the messages, and their transport latencies (for stamped messages)
+     */
+    void activated(const std::vector<Clock::time_point>& receipts,
+                   const std::vector<uint64_t>& transport_us);
+
+    /** Called by the state publisher after each publication period: 'sent'
+     * is false if nothing was published (eg, no subscriber)
+     */
+    void published(bool sent);
+
+    /** Called by the viewer before it reads the state of the network
+     */
+    void frameStarted();
+
+    /** Called by the viewer once the frame is drawn
+     */
+    void frameShown();
+
+    LatencyHistogram histogram(latency_stage stage) const;
+
+    struct Summary {
+        uint64_t count, p50, p99, max;
+    };
+
+    /** Same as reading the histogram, without copying it
+     */
+    Summary summary(latency_stage stage) const;
+
+    Json::Value toJson() const;
+
+    /** Appends the latencies of the last 'period' seconds to 'path', every
+     * 'period' seconds, from a background thread
+     */
+    void startDump(const std::string& path, double period);
+    void stopDump();
+
+    static const char* stageName(latency_stage stage);
+};
+
+#endif // LATENCY_H
@@ -18,17 +18,17 @@
 
 #include <boost/program_options.hpp>
 
+#include <cassert>
 #include <fstream>
+#include <iostream>
+#include <memory>
 #include <json/json.h>
 
 #include <ros/ros.h>
 
-#include "macros.h"
-
-#include "core/sdlapp.h"
-#include "core/display.h"
-
-#include "memoryview.h"
+#include "memoryview_exceptions.h"
+#include "memory_core.h"
+#include "viewer.h"
 
 using namespace std;
 namespace po = boost::program_options;
@@ -41,12 +41,7 @@ int main(int argc, char *argv[]) {
 
     Json::Value config;
 
-    int width;
-    int height;
-    bool fullscreen=false;
-    bool multisample=false;
-
-    int video_framerate = 60;
+    ViewerOptions options;
 
     po::positional_options_description p;
     p.add("configuration", 1);
@@ -59,6 +54,12 @@ int main(int argc, char *argv[]) {
             ("fullscreen,f", "fullscreen")
             ("geometry,g", po::value<string>()->default_value("1024x768"), "window geometry (LxH)")
             ("configuration", po::value<string>(), "rendering configuration (JSON, optional)")
+            ("capacity,c", po::value<int>()->default_value(0), "expected number of units: memory is allocated for them up front")
+            ("latency-report", po::value<string>(), "on exit, write the latencies of the attention messages to a file (JSON)")
+            ("input,i", po::value<string>(), "read the attention targets from a file, a FIFO, a Unix socket ('unix:PATH') or stdin ('-') instead of ROS")
+            ("output-ppm-stream,o", po::value<string>(), "render at a fixed timestep and write the frames to a file ('-' for stdout)")
+            ("output-format", po::value<string>()->default_value("ppm"), "format of the output stream: ppm or y4m")
+            ("output-framerate,r", po::value<int>()->default_value(60), "framerate of the output stream")
             ;
 
     po::variables_map vm;
@@ -81,7 +82,7 @@ int main(int argc, char *argv[]) {
     }
 
     if (vm.count("fullscreen")) {
-        fullscreen = true;
+        options.fullscreen = true;
     }
 
 
@@ -98,73 +99,75 @@ int main(int argc, char *argv[]) {
 
             assert(w!=0 && h!=0);
 
-            width = w;
-            height = h;
-            cerr << "Window size: w=" << width << ", h=" << height << endl;
+            options.width = w;
+            options.height = h;
+            cerr << "Window size: w=" << w << ", h=" << h << endl;
         }
 
 
-    float start_position = 0.0;
-    float stop_position  = 0.0;
-    bool stop_on_idle = false;
-    bool stop_at_end = false;
+    options.output_format = vm["output-format"].as<string>();
+
+    if (vm.count("output-ppm-stream")) {
+        options.output_file = vm["output-ppm-stream"].as<string>();
+
+        // frames go to stdout: messages must not mix with them
+        if (options.output_file == "-") cout.rdbuf(cerr.rdbuf());
+        options.video_framerate = vm["output-framerate"].as<int>();
 
-    std::string camera_mode = "overview";
+        if (options.output_format != "ppm" && options.output_format != "y4m") {
+            cerr << "Unknown output format " << options.output_format << " (must be ppm or y4m)" << endl;
+            return 1;
+        }
+        if (options.video_framerate <= 0) {
+            cerr << "Invalid output framerate " << options.video_framerate << endl;
+            return 1;
+        }
+    }
 
     if (vm.count("configuration")) {
         auto conf = vm["configuration"].as<string>();
         cout << "Using configuration file " << conf << endl;
-        Json::Reader reader;
-        ifstream conf_file(conf, ifstream::binary);
-        bool parsingOk = reader.parse(conf_file, config);
-        if (!parsingOk) {
-            cerr << "Error while parsing the configuration file!\n"
-                 << reader.getFormattedErrorMessages();
+        try {
+            config = MemoryCore::loadConfiguration(conf);
+        } catch(MemoryViewException& exception) {
+            cerr << exception.what();
             exit(1);
         }
     }
 
-    SDLAppInit("Memory View", "memory-view");
+    double decay = vm["decay"].as<double>();
+    double learning = vm["learning"].as<double>();
 
-#ifndef TEXT_ONLY
+    unique_ptr<MemoryCore> core;
 
-    // this causes corruption on some video drivers
-    if(multisample) {
-        display.multiSample(4);
+    if (vm.count("input")) {
+        core.reset(new MemoryCore(config, decay, learning, vm["input"].as<string>()));
     }
-
-    //enable vsync
-    display.enableVsync(true);
-
-    try {
-
-        display.init("Memory View", width, height, fullscreen);
-
-    } catch(SDLInitException& exception) {
-
-        throw MemoryViewException(string("SDL initialization failed ") + exception.what());
+    else {
+        core.reset(new MemoryCore(config, decay, learning));
     }
 
-    if(multisample) glEnable(GL_MULTISAMPLE_ARB);
-
-#endif
+    int capacity = vm["capacity"].as<int>();
+    if (capacity > 0) {
+        core->reserveUnits(capacity);
+        options.capacity = capacity;
+    }
 
     try {
-        MemoryView memoryview(config, vm["decay"].as<double>(), vm["learning"].as<double>());
-        memoryview.run();
-
-    } catch(ResourceException& exception) {
-
-        throw MemoryViewException(string("failed to load resource ") + exception.what());
-
+        core->start();
+    } catch(MemoryViewException& exception) {
+        cerr << exception.what() << endl;
+        exit(1);
     }
 
-#ifndef TEXT_ONLY
+    runViewer(*core, config, options);
 
-    //free resources
-    display.quit();
+    core->stop();
 
-#endif
+    if (vm.count("latency-report")) {
+        ofstream report(vm["latency-report"].as<string>());
+        report << Json::StyledWriter().write(core->report());
+    }
 
     return 0;
 
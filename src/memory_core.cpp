@@ -0,0 +1,204 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <fstream>
+#include <iostream>
+
+#include "memoryview_exceptions.h"
+
+#include "ros_ingest.h"
+#include "stream_ingest.h"
+
+#include "memory_core.h"
+
+using namespace std;
+using namespace std::chrono;
+
+MemoryCore::MemoryCore(const Json::Value& config,
+                       double decay_rate, double learning_rate,
+                       const ros::NodeHandle& nh) :
+    running(false),
+    latency_dump_period(10.0),
+    activations_history(HISTORY_LENGTH, HISTORY_SAMPLING_RATE),
+    memory([this](microseconds time_from_start, const MemoryVector& levels) {
+               activations_history.record(time_from_start, levels);
+           },
+           nullptr, decay_rate, learning_rate)
+{
+    RosIngest* ros_ingest = new RosIngest(memory, nh);
+    ingest.reset(ros_ingest);
+    ingest->setLatencyTracker(&latency);
+
+    publisher.reset(new StatePublisher(memory, nh));
+    publisher->setLatencyTracker(&latency);
+
+    ingestSetup(config);
+    publishSetup(config);
+    latencySetup(config);
+
+    Json::Value in = config["ingest"];
+    if (in != Json::nullValue) {
+        ros_ingest->setSubscriberQueueSize(in.get("subscriber_queue_size", 100).asInt());
+    }
+}
+
+MemoryCore::MemoryCore(const Json::Value& config,
+                       double decay_rate, double learning_rate,
+                       const string& input) :
+    running(false),
+    latency_dump_period(10.0),
+    activations_history(HISTORY_LENGTH, HISTORY_SAMPLING_RATE),
+    memory([this](microseconds time_from_start, const MemoryVector& levels) {
+               activations_history.record(time_from_start, levels);
+           },
+           nullptr, decay_rate, learning_rate)
+{
+    ingest.reset(new StreamIngest(memory, input));
+    ingest->setLatencyTracker(&latency);
+
+    ingestSetup(config);
+    latencySetup(config);
+}
+
+MemoryCore::~MemoryCore() {
+    stop();
+}
+
+void MemoryCore::ingestSetup(const Json::Value& config) {
+
+    Json::Value in = config["ingest"];
+
+    if (in == Json::nullValue) return; // Uses defaults, as specified in ros_ingest.cpp
+
+    cout << "Setting customs attention targets ingestion parameters from config file." << endl;
+
+    ingest->setCapacity(in.get("queue_capacity", 256).asUInt());
+
+    ingest->setWindow(in.get("window_ms", 10.0).asDouble() / 1000.0);
+
+    string coalescing = in.get("coalescing", "max").asString();
+    if (coalescing == "sum") ingest->setCoalescing(COALESCE_SUM);
+    else if (coalescing == "max") ingest->setCoalescing(COALESCE_MAX);
+    else throw MemoryViewException("unknown coalescing mode '" + coalescing + "' (expected 'max' or 'sum')");
+}
+
+void MemoryCore::publishSetup(const Json::Value& config) {
+
+    Json::Value pub = config["publish"];
+
+    if (pub == Json::nullValue) return; // Uses defaults, as specified in state_publisher.cpp
+
+    cout << "Setting customs network state publication parameters from config file." << endl;
+
+    publisher->setRate(pub.get("rate", 10.0).asDouble());
+    publisher->setTopK(pub.get("top_k", 5).asUInt());
+}
+
+void MemoryCore::latencySetup(const Json::Value& config) {
+
+    Json::Value lat = config["latency"];
+
+    if (lat == Json::nullValue) return; // No periodic dump
+
+    cout << "Setting customs latency tracing parameters from config file." << endl;
+
+    latency_dump_file = lat.get("dump_file", "").asString();
+    latency_dump_period = lat.get("dump_period", 10.0).asDouble();
+}
+
+void MemoryCore::reserveUnits(size_t units) {
+    ingest->reserveUnits(units);
+    activations_history.reserve(units);
+}
+
+void MemoryCore::start() {
+
+    if (running) return;
+
+    // a missing attention source is reported before anything is started
+    ingest->openSource();
+
+    cerr << "Memory network initialization" << endl;
+
+    memory.record(true);
+    memory.start();
+
+    cerr << "Subscribing to attentional targets" << endl;
+
+    ingest->start();
+
+    if (publisher) {
+        cerr << "Publishing the state of the network" << endl;
+
+        publisher->start();
+    }
+
+    if (!latency_dump_file.empty()) {
+        cerr << "Dumping the latencies to " << latency_dump_file << endl;
+
+        latency.startDump(latency_dump_file, latency_dump_period);
+    }
+
+    cerr << "Associative memory network up and running" << endl;
+
+    running = true;
+}
+
+void MemoryCore::stop() {
+
+    if (!running) return;
+
+    ingest->stop();
+    if (publisher) publisher->stop();
+    latency.stopDump();
+
+    memory.stop();
+    memory.save_record();
+
+    running = false;
+}
+
+Json::Value MemoryCore::report() const {
+
+    Json::Value report;
+
+    report["latency"] = latency.toJson();
+
+    Json::Value& in = report["ingest"];
+    in["messages"] = (Json::UInt64) ingest->receivedMessages();
+    in["lost"] = (Json::UInt64) ingest->lostMessages();
+    in["targets"] = (Json::UInt64) ingest->attentionQueue().receivedCount();
+    in["coalesced"] = (Json::UInt64) ingest->attentionQueue().coalescedCount();
+    in["dropped"] = (Json::UInt64) ingest->attentionQueue().droppedCount();
+
+    return report;
+}
+
+Json::Value MemoryCore::loadConfiguration(const string& path) {
+
+    Json::Value config;
+    Json::Reader reader;
+
+    ifstream conf_file(path, ifstream::binary);
+
+    if (!reader.parse(conf_file, config)) {
+        throw MemoryViewException("error while parsing the configuration file " + path + ":\n"
+                                  + reader.getFormattedErrorMessages());
+    }
+
+    return config;
+}
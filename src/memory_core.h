@@ -0,0 +1,114 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MEMORY_CORE_H
+#define MEMORY_CORE_H
+
+#include <memory>
+#include <string>
+
+#include <json/json.h>
+#include <ros/ros.h>
+
+#include "AssociativeMemory/memory_network.hpp"
+
+#include "activation_history.h"
+#include "attention_ingest.h"
+#include "latency.h"
+#include "state_publisher.h"
+
+const int HISTORY_SAMPLING_RATE = 500;  // Hz
+const int HISTORY_LENGTH = 1000;  //samples
+
+/**
+ * The memory network and its interfaces (attention targets in, state of the
+ * network out), without any display.
+ *
+ * Shared by the standalone node and the nodelet, which may or may not add a
+ * MemoryView on top of it. Several cores may live in the same process (eg,
+ * nodelets in one manager): each has its own network and history.
+ */
+class MemoryCore {
+
+    bool running;
+
+    void ingestSetup(const Json::Value& config);
+    void publishSetup(const Json::Value& config);
+    void latencySetup(const Json::Value& config);
+
+    std::string latency_dump_file;
+    double latency_dump_period;
+
+public:
+    /** Attention targets from ROS. Topics are advertised and subscribed in
+     * the namespace of 'nh'.
+     */
+    MemoryCore(const Json::Value& config,
+               double decay_rate, double learning_rate,
+               const ros::NodeHandle& nh = ros::NodeHandle());
+
+    /** Attention targets from a stream (see StreamIngest), without ROS: the
+     * state of the network is not published.
+     */
+    MemoryCore(const Json::Value& config,
+               double decay_rate, double learning_rate,
+               const std::string& input);
+
+    ~MemoryCore();
+
+    // Activity of the units, recorded by the network thread. Declared
+    // before the network, which logs into it.
+    ActivationHistory activations_history;
+
+    MemoryNetwork memory;
+
+    // Latencies of the attention messages, from their receipt to their
+    // display
+    LatencyTracker latency;
+
+    // Attention targets, received in their own thread
+    std::unique_ptr<AttentionIngest> ingest;
+
+    // Activations and strongest associations, published in their own
+    // thread. Null without ROS.
+    std::unique_ptr<StatePublisher> publisher;
+
+    /** Allocates the tables indexed by unit (ingestion, activation
+     * history) for 'units' units up front. Must be called before start().
+     */
+    void reserveUnits(size_t units);
+
+    /** Starts the network, then the ingestion and publication threads
+     */
+    void start();
+
+    /** Stops the network and saves its record. Called by the destructor if
+     * needed.
+     */
+    void stop();
+
+    /** Latencies and ingestion counters, as written by --latency-report
+     */
+    Json::Value report() const;
+
+    /** Parses a JSON configuration file. Throws a MemoryViewException on
+     * error.
+     */
+    static Json::Value loadConfiguration(const std::string& path);
+};
+
+#endif // MEMORY_CORE_H
@@ -0,0 +1,112 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+
+#include "memoryview_exceptions.h"
+#include "memory_core.h"
+#include "viewer.h"
+
+using namespace std;
+
+namespace associative_memory_ros {
+
+/**
+ * The memory network as a nodelet: when loaded in the same manager as the
+ * perception pipeline, attention targets are passed as shared pointers,
+ * without serialization.
+ *
+ * Private parameters:
+ *  - config: rendering/ingestion configuration file (JSON, optional)
+ *  - decay, learning: as the options of the standalone node
+ *  - capacity: expected number of units (memory is allocated up front)
+ *  - viewer: if true, also opens a MemoryView window (default: false)
+ *  - width, height, fullscreen: geometry of the window
+ */
+class MemoryNodelet : public nodelet::Nodelet {
+
+    Json::Value config;
+
+    unique_ptr<MemoryCore> core;
+
+    std::thread viewer;
+
+    virtual void onInit() {
+
+        ros::NodeHandle& private_nh = getPrivateNodeHandle();
+
+        string config_path;
+        double decay, learning;
+        bool with_viewer;
+        int capacity;
+
+        private_nh.param("config", config_path, string());
+        private_nh.param("decay", decay, 0.2);
+        private_nh.param("learning", learning, 0.01);
+        private_nh.param("capacity", capacity, 0);
+        private_nh.param("viewer", with_viewer, false);
+
+        ViewerOptions options;
+        private_nh.param("width", options.width, options.width);
+        private_nh.param("height", options.height, options.height);
+        private_nh.param("fullscreen", options.fullscreen, options.fullscreen);
+
+        try {
+            if (!config_path.empty()) config = MemoryCore::loadConfiguration(config_path);
+
+            core.reset(new MemoryCore(config, decay, learning, getMTNodeHandle()));
+
+        } catch(MemoryViewException& exception) {
+            NODELET_ERROR("%s", exception.what());
+            return;
+        }
+
+        if (capacity > 0) {
+            core->reserveUnits(capacity);
+            options.capacity = capacity;
+        }
+
+        core->start();
+
+        if (with_viewer) {
+            viewer = std::thread([this, options]() {
+                try {
+                    runViewer(*core, config, options);
+                } catch(MemoryViewException& exception) {
+                    NODELET_ERROR("%s", exception.what());
+                }
+            });
+        }
+    }
+
+public:
+    virtual ~MemoryNodelet() {
+        if (viewer.joinable()) {
+            closeViewer();
+            viewer.join();
+        }
+    }
+};
+
+}
+
+PLUGINLIB_EXPORT_CLASS(associative_memory_ros::MemoryNodelet, nodelet::Nodelet)
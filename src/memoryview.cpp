@@ -17,10 +17,10 @@
 */
 
 #include <string>
+#include <thread>
 
 #include <boost/foreach.hpp>
 #include <boost/algorithm/string/predicate.hpp>
-#include <boost/circular_buffer.hpp>
 
 
 
@@ -37,40 +37,21 @@ using namespace std;
 using namespace std::chrono;
 using namespace std::chrono_literals;
 
-const int HISTORY_SAMPLING_RATE = 500;  // Hz
-const int HISTORY_LENGTH = 1000;  //samples
+// while idle, input is polled at least every IDLE_WAIT
+const double IDLE_WAIT = 0.02;  // s
 
-map<size_t, boost::circular_buffer<double>> activations_logs;
-
-microseconds last_activations_log;
-
-void logging(microseconds time_from_start, const MemoryVector &levels) {
-
-    // at first call, initialize the circular buffers and set their capacity.
-    if (activations_logs.size() != levels.size()) {
-        for (size_t i=0; i < levels.size(); i++) {
-            activations_logs[i].set_capacity(HISTORY_LENGTH);
-        }
-    }
-
-    // if necessary, store the activation level
-    microseconds us_since_last_log = time_from_start - last_activations_log;
-    if (us_since_last_log.count() > (std::micro::den * 1. / HISTORY_SAMPLING_RATE)) {
-        last_activations_log = time_from_start;
-        for (size_t i = 0; i < levels.size(); i++) {
-            activations_logs[i].push_back(levels[i]);
-        }
-    }
-}
-
-MemoryView::MemoryView(const Json::Value& config, 
-                       double decay_rate, double learning_rate):
+MemoryView::MemoryView(const Json::Value& config, MemoryCore& core):
     config(config),
-    memory(logging, nullptr, decay_rate, learning_rate),
+    core(core),
+    memory(core.memory),
+    scheduler(config.get("target_fps", 60).asFloat(),
+              config.get("adaptive_quality", true).asBool()),
+    footer(FOOTER_SPEED),
+    sparklines(HISTORY_LENGTH),
     display_shadows(config.get("shadows", true).asBool()),
     display_labels(config.get("display_labels", true).asBool()),
     display_footer(config.get("display_footer", false).asBool()),
-    rate(30) //Hz
+    seen_messages(0)
 {
 
 
@@ -103,6 +84,9 @@ MemoryView::MemoryView(const Json::Value& config,
     debug = false;
     advanced_debug = false;
     paused = false;
+    heatmap_mode = false;
+    layout_motion = 0.0f;
+    heatmap_hovered = false;
 
     fontlarge = fontmanager.grab("Aller_Bd.ttf", LARGE_FONT_SIZE);
     fontlarge.dropShadow(true);
@@ -116,17 +100,45 @@ MemoryView::MemoryView(const Json::Value& config,
     font.dropShadow(true);
     font.roundCoordinates(true);
 
+#ifndef TEXT_ONLY
+    // BASE_FONT_SIZE is the largest label size (node labels never grow past
+    // it, activations are drawn smaller), so labels are only scaled down
+    labelfont.load(fontmanager.getDir() + "Aller_Lt.ttf", BASE_FONT_SIZE);
+#endif
+
     camera = ZoomCamera(vec3f(0,0, -300), vec3f(0.0, 0.0, 0.0), 250.0, 5000.0);
 
 #ifndef TEXT_ONLY
-    bloomtex = texturemanager.grab("bloom.tga");
-    beamtex  = texturemanager.grab("beam.png");
+    // all the sprites are packed in a single texture, so that the layers
+    // are drawn without texture switches
+    texturemanager.addSprite("bloom.tga");
+    texturemanager.addSprite("beam.png");
+    texturemanager.addSprite("instances.png");
+    texturemanager.buildAtlas();
+
+    layers.setTexture(texturemanager.getAtlas());
+    layers.setSprite(LAYER_EDGE_SHADOWS, texturemanager.getSprite("beam.png"));
+    layers.setSprite(LAYER_NODE_SHADOWS, texturemanager.getSprite("instances.png"));
+    layers.setSprite(LAYER_EDGES, texturemanager.getSprite("beam.png"));
+    layers.setSprite(LAYER_NODES, texturemanager.getSprite("instances.png"));
+    layers.setSprite(LAYER_BLOOM, texturemanager.getSprite("bloom.tga"));
+
+    heatmap.init();
+    sparklines.init();
 #endif
 
 
 
     stylesSetup(config);
     physicsSetup(config);
+    lodSetup(config);
+    postprocessSetup(config);
+    idleSetup(config);
+
+    core.latency.enable(LATENCY_DISPLAY);
+
+    lod = LOD_NEAR;
+    node_screen_size = NODE_SIZE;
 
     background_colour = BACKGROUND_COLOUR.truncate();
 }
@@ -152,6 +164,8 @@ void MemoryView::stylesSetup(const Json::Value& config) {
         BACKGROUND_COLOUR = convertRGBA2Float(colors["background"]);
     }
 
+    updateColourMaps();
+
 
 }
 
@@ -178,6 +192,26 @@ void MemoryView::physicsSetup(const Json::Value& config) {
 
 }
 
+void MemoryView::lodSetup(const Json::Value& config) {
+
+    Json::Value lod = config["lod"];
+
+    if (lod == Json::nullValue) return; // Uses defaults, as specified in styles.h
+
+    cout << "Setting customs level of detail thresholds from config file." << endl;
+    if (!lod.get("enabled", true).asBool()) {
+        LOD_FAR_NODE_SIZE = 0.0;
+        LOD_MID_NODE_SIZE = 0.0;
+        return;
+    }
+    if (lod["far_node_size"] != Json::nullValue) {
+        LOD_FAR_NODE_SIZE = lod["far_node_size"].asDouble();
+    }
+    if (lod["mid_node_size"] != Json::nullValue) {
+        LOD_MID_NODE_SIZE = lod["mid_node_size"].asDouble();
+    }
+}
+
 vec4f MemoryView::convertRGBA2Float(const Json::Value& color) {
     return vec4f(color[0u].asInt()/255.0,
                  color[1u].asInt()/255.0,
@@ -185,47 +219,56 @@ vec4f MemoryView::convertRGBA2Float(const Json::Value& color) {
                  color[3u].asInt()/255.0);
 }
 
-/** Initialization */
-void MemoryView::init(){
-
+void MemoryView::idleSetup(const Json::Value& config) {
 
-    cerr << "Memory network initialization" << endl;
+    Json::Value idle = config["idle"];
 
-    memory.record(true);
-    memory.start();
+    if (idle == Json::nullValue) return; // Redraws continuously
 
-    cerr << "Subscribing to attentional targets" << endl;
+    cout << "Setting customs idle detection parameters from config file." << endl;
 
-    attention_targets = nh.subscribe("attention_targets", 1, &MemoryView::on_attention_target, this);
+    idleness.activation_threshold = idle.get("activation_threshold", idleness.activation_threshold).asFloat();
+    idleness.weight_threshold = idle.get("weight_threshold", idleness.weight_threshold).asFloat();
+    idleness.position_threshold = idle.get("position_threshold", idleness.position_threshold).asFloat();
+    idleness.camera_threshold = idle.get("camera_threshold", idleness.camera_threshold).asFloat();
 
-    cerr << "Associative memory network up and running" << endl;
+    idleness.setEnabled(idle.get("enabled", true).asBool());
 }
 
-void MemoryView::on_attention_target(const playground_builder::AttentionTargetsStamped::ConstPtr& msg) {
-
-    // activate unit corresponding to current user
-    if (!memory.has_unit(msg->header.frame_id)) memory.add_unit(msg->header.frame_id);
-    memory.activate_unit(msg->header.frame_id, 1.0, chrono::milliseconds(60));
+void MemoryView::postprocessSetup(const Json::Value& config) {
 
+#ifndef TEXT_ONLY
+    Json::Value post = config["postprocess"];
 
-    for (const auto& target : msg->targets) {
-        if (!memory.has_unit(target.frame_id)) memory.add_unit(target.frame_id);
-        memory.activate_unit(target.frame_id, target.intensity, chrono::milliseconds(60));
+    if (post == Json::nullValue) {
+        postprocess.init();
+        return;
     }
 
+    cout << "Setting customs post-processing parameters from config file." << endl;
+    if (!post.get("enabled", true).asBool()) return;
 
+    postprocess.init(post.get("bloom_threshold", 0.0).asFloat(),
+                     post.get("bloom_intensity", 1.0).asFloat());
+#endif
+}
 
+void MemoryView::setFrameExporter(FrameExporter* exporter) {
+    frameExporter = exporter;
 }
 
+/** Initialization */
+void MemoryView::init(){
+}
 
 /** Events */
 void MemoryView::keyPress(SDL_KeyboardEvent *e) {
+    idleness.wake();
+
     if (e->type == SDL_KEYUP) return;
 
     if (e->type == SDL_KEYDOWN) {
         if (e->keysym.sym == SDLK_ESCAPE) {
-            memory.stop();
-            memory.save_record();
             appFinished=true;
         }
 
@@ -255,6 +298,18 @@ void MemoryView::keyPress(SDL_KeyboardEvent *e) {
             paused = !paused;
         }
 
+        if (e->keysym.sym == SDLK_b) {
+            bundler.setEnabled(!bundler.isEnabled());
+        }
+
+        if (e->keysym.sym == SDLK_h) {
+            heatmap_mode = !heatmap_mode;
+
+            // nodes are not picked in the heatmap view
+            if(hoverNode) hoverNode->hovered(false);
+            hoverNode = nullptr;
+        }
+
         if(e->keysym.sym == SDLK_UP) {
             zoom(true);
         }
@@ -263,6 +318,14 @@ void MemoryView::keyPress(SDL_KeyboardEvent *e) {
             zoom(false);
         }
 
+        if(e->keysym.sym == SDLK_PAGEUP) {
+            sparklines.scroll(-1);
+        }
+
+        if(e->keysym.sym == SDLK_PAGEDOWN) {
+            sparklines.scroll(1);
+        }
+
         if(e->keysym.sym == SDLK_s) {
             g.saveToGraphViz(*this);
         }
@@ -275,6 +338,8 @@ void MemoryView::keyPress(SDL_KeyboardEvent *e) {
 
 void MemoryView::mouseClick(SDL_MouseButtonEvent *e) {
 
+    idleness.wake();
+
     if(e->type == SDL_MOUSEBUTTONUP) {
 
         if(e->button == SDL_BUTTON_LEFT || e->button == SDL_BUTTON_MIDDLE) {
@@ -330,6 +395,8 @@ void MemoryView::mouseClick(SDL_MouseButtonEvent *e) {
 
 void MemoryView::mouseMove(SDL_MouseMotionEvent *e) {
 
+    idleness.wake();
+
     mousepos = vec2f(e->x, e->y);
 
     if(mousedragged) {
@@ -355,34 +422,83 @@ void MemoryView::mouseMove(SDL_MouseMotionEvent *e) {
 /** main update function */
 void MemoryView::update(float t, float dt) {
 
-    SDL_Delay(20); //TODO Not too quick...
+    if (frameExporter) {
+        // When exporting, we render as fast as possible, at the fixed
+        // timestep of the video
+        dt = 1.0f / frameExporter->getFramerate();
+    }
+    else {
+        // Wait for the remaining of the frame budget (incoming messages are
+        // processed by the ingest thread in the meantime)
+        scheduler.waitNextFrame([](float remaining_ms) {
+            this_thread::sleep_for(duration<float, milli>(remaining_ms));
+        });
 
-    dt = min(dt, max_tick_rate);
+        dt = min(dt, max_tick_rate);
+    }
+
+    uint64_t messages = core.ingest->messageCount();
+    if (messages != seen_messages) {
+        seen_messages = messages;
+        idleness.wake();
+    }
+
+    idleness.checkNetwork(memory, dt);
 
     dt *= time_scale;
 
     //have to manage runtime internally as we're messing with dt
     runtime += dt;
 
-    logic_time = SDL_GetTicks();
+    scheduler.begin(STAGE_LOGIC);
+
+    // activations applied so far are read by this frame
+    core.latency.frameStarted();
 
     logic(runtime, dt);
 
-    logic_time = SDL_GetTicks() - logic_time;
+    scheduler.end(STAGE_LOGIC);
+
+    scheduler.begin(STAGE_DRAW);
 
-    draw_time = SDL_GetTicks();
+    if (frameExporter) frameExporter->begin();
 
     draw(runtime, dt);
 
+    if (frameExporter) frameExporter->capture();
+
+    scheduler.end(STAGE_DRAW);
+
+    core.latency.frameShown();
+
+    // the footer scrolls until it is empty
+    idleness.frameDrawn(dt, layout_motion, camera.getPos(),
+                        display_footer && !footer.empty());
+
     framecount++;
+}
+
+bool MemoryView::isIdle() {
+    return !frameExporter && idleness.isIdle();
+}
 
+void MemoryView::idle(float dt) {
 
-    ros::spinOnce();
+    // blocks until a message arrives, or for at most IDLE_WAIT
+    uint64_t messages = core.ingest->waitForMessages(seen_messages, IDLE_WAIT);
+    if (messages != seen_messages) {
+        seen_messages = messages;
+        idleness.wake();
+    }
+
+    idleness.checkNetwork(memory, dt);
 }
 
 /** App logic */
 void MemoryView::logic(float t, float dt) {
-    if(draw_loading && logic_time > 1000) draw_loading = false;
+    if(draw_loading && runtime > 1.0f) draw_loading = false;
+
+    layout_motion = 0.0;
 
     //still want to update camera while paused
     if(paused) {
@@ -405,73 +521,30 @@ void MemoryView::logic(float t, float dt) {
         memory.activate_unit(hoverNode->getID(), 1.0, 40000us);
     }
 
-    updateFromMemoryNetwork(memory);
-    g.step(dt);
+    if (heatmap_mode) {
+        // the graph is neither updated nor simulated while hidden
+        heatmap.update(memory, dt);
+    }
+    else {
+        updateFromMemoryNetwork(memory);
+        layout_motion = g.step(dt);
+        bundler.update(g, dt);
+    }
 
     updateCamera(dt);
 }
 
 void MemoryView::mouseTrace(Frustum& frustum, float dt) {
 
-    GLuint	buffer[512];
-    GLint	viewport[4];
-
-    glGetIntegerv(GL_VIEWPORT, viewport);
-    glSelectBuffer(512, buffer);
-
-    glDepthFunc(GL_LEQUAL);
-    glEnable(GL_DEPTH_TEST);
-
-    /** Start the selection of primitives touched by the mouse **/
-    (void) glRenderMode(GL_SELECT);
-
-    glInitNames();
-    glPushName(0);
-
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-
-    //Restrict the detection to a zone around of the mouse
-    gluPickMatrix((GLdouble) mousepos.x, (GLdouble) (viewport[3]-mousepos.y), 1.0f, 1.0f, viewport);
-    gluPerspective(90.0f, (GLfloat)display.width/(GLfloat)display.height, 0.1f, camera.getZFar());
-    camera.look();
-
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-
-    glDisable(GL_TEXTURE_2D);
-    glColor4f(1.0, 1.0, 1.0, 1.0);
-
-    g.render(SIMPLE, *this);
-
-    glMatrixMode(GL_MODELVIEW);
-
-    //going back to the GL_RENDER mode, returning the number of hits from hte GL_SELECT mode
-    mouse_hits = glRenderMode(GL_RENDER);
-    /** End of selection **/
-
+    // picking is done on the CPU, against the node quads of the last frame
     Node* nodeSelection = nullptr;
 
-    if (mouse_hits > 0) {
+    int choice = layers.pick(mousepos);
 
-        int choice   = buffer[3];
-        GLuint depth = buffer[1];
-
-        for (int loop = 1; loop < mouse_hits; loop++) {
-            if (buffer[loop*4+1] < depth) {
-                choice = buffer[loop*4+3];
-                depth  = buffer[loop*4+1];
-            }
-        }
-
-        if(choice != 0) {
-            selectionDepth = depth;
-            nodeSelection = &g.getNode(choice - 1); // cf node_rendered for the rationale of the -1 (basically, to make sure we can select the node 0)
-        }
+    if(choice >= 0) {
+        nodeSelection = &g.getNode(choice);
     }
 
-    glDisable(GL_DEPTH_TEST);
-
     // is over a file
     if(nodeSelection) {
 
@@ -533,8 +606,6 @@ void MemoryView::drawNodeDetails(Node* node, int offset, bool highlight) {
         font.print(15, v_offset + height - 5,"0");
         font.print(5, v_offset + height - height * memory.Amin - 5 ,"-0.2");
 
-        glBindTexture(GL_TEXTURE_2D, beamtex->textureid);
-
         glDisable(GL_TEXTURE_2D);
         // graph bounding box
         glBegin(GL_LINE_STRIP);
@@ -554,7 +625,8 @@ void MemoryView::drawNodeDetails(Node* node, int offset, bool highlight) {
 
         // graph itself
         glColor4f(1.f, .2f, 0.2f, 1.f);
-        auto history = activations_logs[node->getID()];
+        vector<float> history;
+        core.activations_history.read(node->getID(), 0, history);
 
         glBegin(GL_LINE_STRIP);
         for(int i=0;i<history.size();i++) {
@@ -574,6 +646,46 @@ void MemoryView::drawNodeDetails(Node* node, int offset, bool highlight) {
 }
 
 /** Drawing */
+void MemoryView::drawGraph() {
+
+    updateLevelOfDetail();
+
+    // Single traversal of the graph, filling all the layers at once
+    bool shadows = display_shadows && lod != LOD_FAR && scheduler.allow(PASS_SHADOWS);
+    bool bloom = lod != LOD_FAR && scheduler.allow(PASS_BLOOM);
+
+    // with post-processing, node shadows and bloom are screen-space effects
+    // and are not built per node
+    layers.clear();
+    layers.enable(LAYER_EDGE_SHADOWS, shadows);
+    layers.enable(LAYER_NODE_SHADOWS, shadows && !postprocess.isEnabled());
+    layers.enable(LAYER_BLOOM, bloom && !postprocess.isEnabled());
+    layers.enableLabels(display_labels && lod != LOD_FAR && scheduler.allow(PASS_LABELS));
+
+    if (layers.labelsEnabled()) labels.begin(labelfont);
+
+    g.build(layers, *this);
+
+    //Draw shadows, edges, nodes and then bloom
+    glPointSize(max(2.0f, node_screen_size));
+    if (postprocess.isEnabled()) postprocess.draw(layers, shadows, bloom);
+    else layers.draw();
+
+    //Draw names
+    if (layers.labelsEnabled()) labels.draw();
+}
+
+void MemoryView::drawHeatmapDetails(int offset) {
+
+    if (!heatmap_hovered) return;
+
+    glColor4f(0.f, 0.f, 0.f, 1.f);
+    fontmedium.print(10, offset, "%s -> %s: %.4f",
+                                 heatmap.getName(heatmap_row).c_str(),
+                                 heatmap.getName(heatmap_column).c_str(),
+                                 heatmap.getWeight(heatmap_row, heatmap_column));
+}
+
 void MemoryView::draw(float t, float dt) {
 
     auto selectedNodes = g.getAllSelected();
@@ -586,12 +698,6 @@ void MemoryView::draw(float t, float dt) {
 
     Frustum frustum(camera);
 
-    trace_time = SDL_GetTicks();
-
-    mouseTrace(frustum,dt);
-
-    trace_time = SDL_GetTicks() - trace_time;
-
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
 
@@ -599,32 +705,32 @@ void MemoryView::draw(float t, float dt) {
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
 
-#endif
-    glEnable(GL_TEXTURE_2D);
-    glEnable(GL_BLEND);
+    if (heatmap_mode) {
+        heatmap.draw();
 
-    //Draw shadows for edges and then nodes
-    if (display_shadows) g.render(SHADOWS, *this, advanced_debug);
+        // needs the 3D matrices, hence done here
+        heatmap_hovered = heatmap.cellAt(mousepos, heatmap_row, heatmap_column);
+    }
+    else {
+        scheduler.begin(STAGE_TRACE);
 
-    //Draw edges and then nodes
-    glBindTexture(GL_TEXTURE_2D, beamtex->textureid);
-    g.render(NORMAL, *this, advanced_debug);
+        mouseTrace(frustum,dt);
 
-    //draw 'gourceian blur' around dirnodes
-    glBlendFunc (GL_ONE, GL_ONE);
-    glBindTexture(GL_TEXTURE_2D, bloomtex->textureid);
-    //Draw Bloom
-    g.render(BLOOM, *this, advanced_debug);
-    glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        scheduler.end(STAGE_TRACE);
+    }
 
-    //Draw names
-    if (display_labels) g.render(NAMES, *this, advanced_debug);
+#endif
+    if (!heatmap_mode) drawGraph();
 
 #ifndef TEXT_ONLY
 
 
 
-    if(advanced_debug) {
+    if(advanced_debug && !heatmap_mode) {
+
+        glEnable(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, texturemanager.getAtlas());
+        g.drawForces();
 
         glDisable(GL_TEXTURE_2D);
         glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
@@ -653,14 +759,29 @@ void MemoryView::draw(float t, float dt) {
                             _activate_on_hover ? "EXCITATE" : "INSPECT");
 
     int display_offset = 80;
+    if (heatmap_mode) {
+        drawHeatmapDetails(display_offset);
+    }
     if(hoverNode) {
         drawNodeDetails(hoverNode, display_offset, true);
     }
     display_offset += 120;
 
-    for (auto node : selectedNodes) {
-        drawNodeDetails(node, display_offset, false);
-        display_offset += 120;
+    if (!selectedNodes.empty()) {
+        vector<size_t> units;
+        vector<string> names;
+        for (auto node : selectedNodes) {
+            units.push_back(node->getID());
+            names.push_back(node->label);
+        }
+
+        sparklines.setUnits(units, names, labelfont);
+        sparklines.update(core.activations_history);
+
+        // leaves room for the footer
+        sparklines.draw(labelfont, 10, display_offset,
+                        display.width / 3, display.height - display_offset - 100,
+                        memory.Amin);
     }
 
     int offset = 200;
@@ -674,20 +795,45 @@ void MemoryView::draw(float t, float dt) {
 
         font.print(10,offset + 20, "FPS: %.2f", fps);
         font.print(10,offset + 40,"Time Scale: %.2f", time_scale);
+        font.print(10,offset + 60,"Level of detail: %s (nodes: %.1f px)",
+                                  lod == LOD_FAR ? "far" : (lod == LOD_MID ? "mid" : "near"),
+                                  node_screen_size);
         font.print(10,offset + 80,"Nodes: %d", g.nodesCount());
         font.print(10,offset + 100,"Edges: %d", g.edgesCount());
+        if (bundler.isEnabled()) {
+            font.print(10,offset + 120,"Edge bundles: %lu clusters", (unsigned long) bundler.clusterCount());
+        }
 
         font.print(10,offset + 140,"Camera: (%.2f, %.2f, %.2f)", campos.x, campos.y, campos.z);
         font.print(10,offset + 160,"Gravity: %.2f", GRAVITY);
-        font.print(10,offset + 180,"Logic Time: %u ms", logic_time);
-        font.print(10,offset + 200,"Mouse Trace: %u ms", trace_time);
-        font.print(10,offset + 220,"Draw Time: %u ms", SDL_GetTicks() - draw_time);
+        font.print(10,offset + 180,"Logic Time: %.1f ms", scheduler.stageTime(STAGE_LOGIC));
+        font.print(10,offset + 200,"Mouse Trace: %.1f ms", scheduler.stageTime(STAGE_TRACE));
+        font.print(10,offset + 220,"Draw Time: %.1f ms (budget: %.1f ms, %d pass(es) dropped)",
+                                   scheduler.stageTime(STAGE_DRAW),
+                                   scheduler.budgetTime(),
+                                   scheduler.degradedPasses());
+        font.print(10,offset + 240,"Attention messages: %lu, %lu lost (targets: %lu coalesced, %lu dropped)",
+                                   (unsigned long) core.ingest->receivedMessages(),
+                                   (unsigned long) core.ingest->lostMessages(),
+                                   (unsigned long) core.ingest->attentionQueue().coalescedCount(),
+                                   (unsigned long) core.ingest->attentionQueue().droppedCount());
+
+        for (int i = 0; i < LATENCY_STAGE_COUNT; i++) {
+            auto stage = (latency_stage) i;
+            auto latency = core.latency.summary(stage);
+            font.print(10,offset + 260 + i * 20,"Latency %s: p50 %.1f ms, p99 %.1f ms, max %.1f ms (%lu)",
+                                   LatencyTracker::stageName(stage),
+                                   latency.p50 / 1000.0,
+                                   latency.p99 / 1000.0,
+                                   latency.max / 1000.0,
+                                   (unsigned long) latency.count);
+        }
 
         if(hoverNode) {
-            font.print(10,offset + 260,"Node %s:", hoverNode->label.c_str());
-            font.print(40,offset + 280,"Speed: (%.2f, %.2f)", hoverNode->speed.x, hoverNode->speed.y);
-            font.print(40,offset + 300,"Charge: %.2f", hoverNode->charge);
-            font.print(40,offset + 320,"Kinetic energy: %.2f", hoverNode->kinetic_energy);
+            font.print(10,offset + 360,"Node %s:", hoverNode->label.c_str());
+            font.print(40,offset + 380,"Speed: (%.2f, %.2f)", hoverNode->speed.x, hoverNode->speed.y);
+            font.print(40,offset + 400,"Charge: %.2f", hoverNode->charge);
+            font.print(40,offset + 420,"Kinetic energy: %.2f", hoverNode->kinetic_energy);
         }
 
     }
@@ -713,40 +859,14 @@ void MemoryView::queueNodeInFooter(int id) {
     queueInFooter(g.getNode(id).renderer.getLabel());
 }
 void MemoryView::queueInFooter(const string& text) {
-
-    int max_x = display.width + 10;
-
-    // Ensure we do not overlap with previous text
-    typedef pair<const string, int> mypair;
-    for(auto elem : footer_content) {
-        int x = elem.second + fontlarge.getWidth(elem.first);
-        max_x = max(x + 50, max_x);
-    }
-
-    footer_content[text] = max_x;
+    footer.queue(text, fontlarge, display.width);
 }
 
 void MemoryView::drawFooter() {
 
     glColor4f(1.0f, 1.0f, 0.8f, 0.7f);
 
-    for( map<string, int>::iterator iter = footer_content.begin() ;
-         iter != footer_content.end() ;
-         ) {
-
-        if (iter->second < -fontlarge.getWidth(iter->first)) {
-            map<string, int>::iterator elem_to_remove = iter++;
-            footer_content.erase(elem_to_remove);
-            continue;
-        }
-
-        fontlarge.print(iter->second,display.height - fontlarge.getFontSize() - 20, "%s", iter->first.c_str());
-
-        iter->second -= FOOTER_SPEED;
-
-        iter++;
-    }
-
+    footer.draw(fontlarge, display.height - fontlarge.getFontSize() - 20);
 }
 
 void MemoryView::loadingScreen() {
@@ -768,6 +888,8 @@ void MemoryView::drawVector(vec2f vec, vec2f pos, vec4f col) {
 
     float radius = 5.0;
 
+    const TextureRegion& beam = texturemanager.getSprite("beam.png");
+
     //conversion not optimal
     float angle = atan2(vec.y, vec.x) * 180 / 3.1415926;
 
@@ -781,15 +903,15 @@ void MemoryView::drawVector(vec2f vec, vec2f pos, vec4f col) {
 
     // src point
 
-    glTexCoord2f(0.0,0.0);
+    glTexCoord2f(beam.u(0.0), beam.v(0.0));
     glVertex2f(0, -radius/3);
-    glTexCoord2f(1.0,0.0);
+    glTexCoord2f(beam.u(1.0), beam.v(0.0));
     glVertex2f(0, radius/3);
 
     // dest point
-    glTexCoord2f(1.0,0.0);
+    glTexCoord2f(beam.u(1.0), beam.v(0.0));
     glVertex2f(vec.length() - 5.0, radius/3);
-    glTexCoord2f(0.0,0.0);
+    glTexCoord2f(beam.u(0.0), beam.v(0.0));
     glVertex2f(vec.length() - 5.0, -radius/3);
 
 
@@ -798,11 +920,11 @@ void MemoryView::drawVector(vec2f vec, vec2f pos, vec4f col) {
     //Arrow
     glBegin(GL_TRIANGLES);
 
-    glTexCoord2f(0.0,0.0);
+    glTexCoord2f(beam.u(0.0), beam.v(0.0));
     glVertex2f(vec.length() - radius, -radius/2);
-    glTexCoord2f(0.5,1.0);
+    glTexCoord2f(beam.u(0.5), beam.v(1.0));
     glVertex2f(vec.length(), 0);
-    glTexCoord2f(1.0,0.0);
+    glTexCoord2f(beam.u(1.0), beam.v(0.0));
     glVertex2f(vec.length() - radius, radius/2);
 
     glEnd();
@@ -832,6 +954,21 @@ void MemoryView::updateCamera(float dt) {
     camera.logic(dt);
 }
 
+void MemoryView::updateLevelOfDetail() {
+
+    float distance = fabs(camera.getPos().z);
+    if (distance < 1.0) distance = 1.0;
+
+    //visible height of the z=0 plane at that distance
+    float visible_height = tan( camera.getFov() * 0.5f * DEGREES_TO_RADIANS ) * 2.0 * distance;
+
+    node_screen_size = NODE_SIZE * display.height / visible_height;
+
+    if (node_screen_size < LOD_FAR_NODE_SIZE) lod = LOD_FAR;
+    else if (node_screen_size < LOD_MID_NODE_SIZE) lod = LOD_MID;
+    else lod = LOD_NEAR;
+}
+
 void MemoryView::zoom(bool zoomin) {
 
     float min_distance = camera.getMinDistance();
@@ -841,7 +978,10 @@ void MemoryView::zoom(bool zoomin) {
 
     if(zoomin) {
         min_distance /= zoom_multi;
-        if(min_distance < 100.0) min_distance = 100.0;
+
+        // cells of large weight matrices are much smaller than nodes
+        float closest = heatmap_mode ? 10.0 : 100.0;
+        if(min_distance < closest) min_distance = closest;
 
         camera.setMinDistance(min_distance);
     } else {
@@ -905,36 +1045,77 @@ void MemoryView::addSelectedNode(Node* node) {
     }
 }
 
-void MemoryView::initFromMemoryNetwork() {
+void MemoryView::reserveUnits(size_t units) {
 
+    g.reserve(units);
+
+#ifndef TEXT_ONLY
+    heatmap.reserve(units);
+#endif
 
-    for (size_t i = 0; i < memory.size(); i++) {
-        Node& n = g.addNode(i, memory.units_names()[i]);
+    // one value per node, then per edge
+    if (units > 1) {
+        colour_values.reserve(units * (units - 1) / 2);
+        colours.reserve(units * (units - 1) / 2);
     }
+}
+
+void MemoryView::initFromMemoryNetwork() {
+
+    // units are only ever added: only the new ones, and their edges to all
+    // the others, are added to the graph
+    size_t known = g.nodesCount();
+
+    auto names = memory.units_names();
 
-    for (size_t i = 0; i < memory.size()-1; i++) {
-        for (size_t j = i+1; j < memory.size(); j++) {
+    for (size_t j = known; j < names.size(); j++) {
+        Node& n = g.addNode(j, names[j]);
 
-            auto& n1 = g.getNode(i);
-            auto& n2 = g.getNode(j);
-            if(!g.getEdge(n1, n2)) g.addEdge(n1, n2);
+        for (size_t i = 0; i < j; i++) {
+            g.addEdge(g.getNode(i), n);
         }
     }
-
 }
 
 void MemoryView::updateFromMemoryNetwork(const MemoryNetwork& memory) {
 
     if (memory.size() > g.nodesCount()) initFromMemoryNetwork();
 
-    for (size_t i = 0; i < memory.size(); i++) {
-        g.getNode(i).activity = memory.activations()(i);
+    // the network returns copies: fetched once per update
+    auto activations = memory.activations();
+    auto weights = memory.weights();
+
+    // colours of all the nodes, then of all the edges, in one pass each
+    size_t count = min((size_t) activations.size(), (size_t) g.nodesCount());
+
+    colour_values.resize(count);
+    colours.resize(count);
+
+    for (size_t i = 0; i < count; i++) colour_values[i] = activations(i);
+
+    ACTIVATION_COLOURS.map(colour_values.data(), count, colours.data());
+
+    for (size_t i = 0; i < count; i++) {
+        Node& node = g.getNode(i);
+        node.activity = activations(i);
+        node.renderer.activation_col = colours[i];
     }
 
-    for (auto& edge : *g.getEdges()) {
-        edge.setWeight(memory.weights()(edge.getId1(),edge.getId2()));
+    auto& edges = *g.getEdges();
+
+    colour_values.resize(edges.size());
+    colours.resize(edges.size());
+
+    for (size_t i = 0; i < edges.size(); i++) {
+        colour_values[i] = weights(edges[i].getId1(), edges[i].getId2());
     }
 
+    WEIGHT_COLOURS.map(colour_values.data(), edges.size(), colours.data());
+
+    for (size_t i = 0; i < edges.size(); i++) {
+        edges[i].setWeight(weights(edges[i].getId1(), edges[i].getId2()));
+        edges[i].setWeightColour(colours[i]);
+    }
 
 }
 
@@ -21,13 +21,13 @@
 
 #include <json/json.h>
 
-#include <ros/ros.h>
-#include <playground_builder/AttentionTargetsStamped.h>
 
 #include "core/display.h"
 #include "core/sdlapp.h"
 #include "core/frustum.h"
 #include "core/fxfont.h"
+#include "core/glyphatlas.h"
+#include "core/ppm.h"
 
 #include "zoomcamera.h"
 
@@ -35,6 +35,15 @@
 #include "constants.h"
 
 #include "graph.h"
+#include "frame_scheduler.h"
+#include "idle_detector.h"
+#include "footer_ticker.h"
+#include "sparklines.h"
+#include "edge_bundler.h"
+#include "memory_core.h"
+#include "render_layers.h"
+#include "postprocess.h"
+#include "heatmap_view.h"
 
 #include "AssociativeMemory/memory_network.hpp"
 
@@ -48,18 +57,23 @@ class MemoryView : public SDLApp {
     //Graph
     Graph g;
 
-    // Memory network
-    MemoryNetwork memory;
+    // Memory network, and its ROS interfaces
+    MemoryCore& core;
+    MemoryNetwork& memory;
 
     //Time
     time_t currtime;
 
-    Uint32 draw_time;
-    Uint32 logic_time;
-    Uint32 trace_time;
+    // Paces the frames, and measures logic, trace and draw times
+    FrameScheduler scheduler;
 
     float idle_time;
 
+    // Stops redrawing when nothing visible changes
+    IdleDetector idleness;
+    // largest displacement of a node during the last step
+    float layout_motion;
+
     float time_scale;
 
     float runtime;
@@ -78,8 +92,6 @@ class MemoryView : public SDLApp {
     bool _activate_on_hover = false;
 
     //Mouse
-    GLint mouse_hits;
-
     bool mousemoved;
     bool mouseleftclicked;
     bool mouserightclicked;
@@ -91,16 +103,18 @@ class MemoryView : public SDLApp {
 
     vec2f mousepos;
 
-    GLuint selectionDepth;
-
     //Background
     vec2f backgroundPos;
     vec3f background_colour;
 
     void selectBackground();
 
-    //Footer content maps a text to write to it's X coordinate.
-    std::map<std::string, int> footer_content;
+    // scratch buffers of updateFromMemoryNetwork
+    std::vector<float> colour_values;
+    std::vector<vec4f> colours;
+
+    //Footer: names of the recently selected nodes
+    FooterTicker footer;
     void queueInFooter(const std::string& text);
     void queueNodeInFooter(int id);
     void drawFooter();
@@ -125,12 +139,30 @@ class MemoryView : public SDLApp {
 
     bool paused;
 
-    //Resources
-    TextureResource* bloomtex;
-    TextureResource* beamtex;
+    // If set, frames are rendered at a fixed timestep and exported
+    FrameExporter* frameExporter = nullptr;
+
+    // Vertex lists of the graph, rebuilt every frame
+    RenderLayers layers;
+
+    // Screen-space bloom and node shadows, if supported
+    PostProcess postprocess;
+
+    // Activity plots of the selected nodes
+    Sparklines sparklines;
+
+    // Weight matrix view, for networks too large for the graph view.
+    // Toggled by pushing on H during runtime
+    HeatmapView heatmap;
+    bool heatmap_mode;
+    // cell under the mouse, if any
+    bool heatmap_hovered;
+    size_t heatmap_row, heatmap_column;
+    void drawHeatmapDetails(int offset);
 
 
     //Drawing routines
+    void drawGraph();
     void drawBloom(Frustum &frustum, float dt);
     void drawBackground(float dt);
     void displayCoulombField();
@@ -145,6 +177,10 @@ class MemoryView : public SDLApp {
     void updateCamera(float dt);
     void zoom(bool zoomin);
 
+    // on-screen size of a node, in pixels, at the current camera distance
+    float node_screen_size;
+    void updateLevelOfDetail();
+
     //Testing
     /**
       Adds (amount) of new nodes to the graph, with (nb_rel) random connections to other nodes
@@ -153,6 +189,9 @@ class MemoryView : public SDLApp {
 
     void stylesSetup(const Json::Value& config);
     void physicsSetup(const Json::Value& config);
+    void lodSetup(const Json::Value& config);
+    void postprocessSetup(const Json::Value& config);
+    void idleSetup(const Json::Value& config);
     vec4f convertRGBA2Float(const Json::Value& color);
 
     // If false, do not display shadows
@@ -166,28 +205,50 @@ class MemoryView : public SDLApp {
     // ROS
     //////////////////////////////////////////////////////////////
     
-    ros::NodeHandle nh;
-    ros::Rate rate;
-    ros::Subscriber attention_targets;
-
-    void on_attention_target(const playground_builder::AttentionTargetsStamped::ConstPtr& msg);
+    // attention messages already accounted for by the idle detection
+    uint64_t seen_messages;
     
 public:
-    MemoryView(const Json::Value& config, double decay_rate, double learning_rate);
+    /** The core is started and stopped by its owner
+     */
+    MemoryView(const Json::Value& config, MemoryCore& core);
+
+    /** Allocates the graph, the heatmap and the per-frame buffers for
+     * 'units' units up front
+     */
+    void reserveUnits(size_t units);
 
     //Public resources
     FXFont font, fontlarge, fontmedium;
 
+    // Node and edge labels are rendered from a glyph atlas, in one batch
+    // per frame
+    GlyphAtlas labelfont;
+    TextBatch labels;
+
     // Textual version of the graph, in dot format.
-    // Filled when calling render on node and/or edge in GRAPHVIZ mode
+    // Filled by Graph::saveToGraphViz
     std::stringstream graphvizGraph;
 
     //Public camera
     ZoomCamera camera;
 
+    // Level of detail for the current frame, computed from the camera
+    // distance. Read by the node and edge renderers.
+    level_of_detail lod;
+
+    // If enabled, edges between clusters of nodes are aggregated in
+    // bundles. Toggled by pushing on B during runtime
+    EdgeBundler bundler;
+
     //Initialisation
     void init(); //overrides SDLApp::init
 
+    /** Renders at the fixed timestep of the exporter framerate, and
+     * sends every frame to the exporter.
+     */
+    void setFrameExporter(FrameExporter* exporter);
+
     //Events overrides
     void keyPress(SDL_KeyboardEvent *e) override;
     void mouseClick(SDL_MouseButtonEvent *e) override;
@@ -198,6 +259,10 @@ public:
     void logic(float t, float dt) override;
     void draw(float t, float dt) override;
 
+    //Idle overrides
+    bool isIdle() override;
+    void idle(float dt) override;
+
     //Background
     void setBackground(vec3f background);
 
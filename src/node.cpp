@@ -108,8 +108,6 @@ bool Node::isConnectedTo(Node* node) {
 
 NodeRelation& Node::addRelation(Node& to) {
 
-    vector<const NodeRelation*> rels = getRelationTo(to);
-
     relations.push_back(NodeRelation(this, &to)); //Add a new relation
 
     if (!to.isConnectedTo(this)){
@@ -141,13 +139,6 @@ void Node::updateKineticEnergy() {
 
 void Node::step(Graph& g, float dt){
 
-    TRACE("Updating " << label << " color based on activity");
-    if (activity > 0)
-        setColour(vec4f(activity + 0.1, activity * 0.5 + 0.1, 0.1, 1.0));
-    else
-        setColour(vec4f(0.1,0.1, -activity + 0.1, 1.0));
-
-
     /** Compute here the new position of the node **/
 
     TRACE("Stepping for node " << label);
@@ -186,25 +177,19 @@ void Node::step(Graph& g, float dt){
 
 }
 
-void Node::render(rendering_mode mode, MemoryView& env, bool debug){
+void Node::build(RenderLayers& layers, MemoryView& env){
 
 #ifndef TEXT_ONLY
-        if (mode == GRAPHVIZ) {
-            env.graphvizGraph << safeid;
-        }
         renderer.activation = activity;
-        renderer.draw(pos, mode, env, distance_to_selected);
-
-        if (debug) {
-            vec4f col(1.0, 0.2, 0.2, 0.7);
-            MemoryView::drawVector(hookeForce , pos, col);
+        renderer.build(pos, layers, env);
+#endif
 
-            col = vec4f(0.2, 1.0, 0.2, 0.7);
-            MemoryView::drawVector(coulombForce , pos, col);
-        }
+}
 
-#endif
+void Node::toGraphViz(MemoryView& env){
 
+        env.graphvizGraph << safeid;
+        renderer.toGraphViz(pos, env);
 }
 
 void Node::decay() {
@@ -111,13 +111,15 @@ public:
       */
     void step(Graph& g, float dt);
 
-     /**
-      Renders the node. If called with rendering mode 'SIMPLE', goes in simple mode.
+    /**
+      Adds the node to the layers of the frame.
+      */
+    void build(RenderLayers& layers, MemoryView& env);
 
-      In simple mode, no special effects are rendered. Useful for picking selected
-      primitive in OpenGL GL_SELECT mode.
+    /**
+      Writes the node to env.graphvizGraph, in dot format.
       */
-    void render(rendering_mode mode, MemoryView& env, bool debug = false);
+    void toGraphViz(MemoryView& env);
 
     void decay();
 
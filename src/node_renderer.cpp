@@ -25,9 +25,10 @@
 using namespace std;
 
 NodeRenderer::NodeRenderer(int tagid, string label) :
-    tagid(tagid),
-    label(label),
     idle_time(0.0),
+    label(label),
+    activation_label(1),
+    tagid(tagid),
     hovered(false),
     selected(false),
     base_size(NODE_SIZE),
@@ -37,9 +38,11 @@ NodeRenderer::NodeRenderer(int tagid, string label) :
     size = base_size * 1.2;
     fontsize = base_fontsize;
 
+    activation_col = ACTIVATION_COLOURS(0.0);
+
 #ifndef TEXT_ONLY
     base_col = UNITS_COLOUR;
-    icon = texturemanager.grab("instances.png");
+    icon = &texturemanager.getSprite("instances.png");
 
     col = base_col * 1.2;
 #endif
@@ -60,14 +63,7 @@ void NodeRenderer::computeColourSize() {
 
     }
     if (hovered) col = HOVERED_COLOUR;
-    else {
-        if (activation > 0) {
-            col = UNITS_COLOUR + ((ACTIVE_COLOUR - UNITS_COLOUR) * activation);
-        }
-        else {
-            col = UNITS_COLOUR + ((INHIBITED_COLOUR - UNITS_COLOUR) * -activation);
-        }
-    }
+    else col = activation_col;
 }
 
 void NodeRenderer::decay() {
@@ -89,193 +85,77 @@ void NodeRenderer::increment_idle_time(float dt) {
     else idle_time += dt;
 }
 
-void NodeRenderer::draw(const vec2f& pos, rendering_mode mode, MemoryView& env, int distance_to_selected) {
+void NodeRenderer::build(const vec2f& pos, RenderLayers& layers, MemoryView& env) {
 
-    std::stringstream str;
-    str << fixed << setprecision( 1 ) << activation;
+    computeColourSize();
 
-    switch (mode) {
-
-    case NORMAL:
-    case SIMPLE:
-        computeColourSize();
-
-        drawSimple(pos);
-        break;
+    col.w = 1.0;
 
-    case NAMES:
-        if(!label.empty()) drawName(pos + vec2f(5,-2), env.font, label);
-        drawName(pos + vec2f(5,8), env.font, str.str(), 0.8);
+    float alpha = getAlpha();
 
-        break;
+    float ratio = icon->h / (float) icon->w;
+    float halfsize = size * 0.5f;
+    vec2f offsetpos = pos - vec2f(halfsize, halfsize);
+    vec2f extent(size, size * ratio);
 
-    case BLOOM:
-        drawBloom(pos);
-        break;
+    if (layers.isEnabled(LAYER_NODE_SHADOWS)) {
+        layers.rect(LAYER_NODE_SHADOWS, offsetpos + SHADOW_OFFSET, extent,
+                    vec4f(0.0, 0.0, 0.0, SHADOW_STRENGTH * alpha));
+    }
 
-    case SHADOWS:
-        drawShadow(pos);
-        break;
+    // the alpha of the node quad is its fade, for screen-space shadows and
+    // bloom (see RenderLayers)
+    if (env.lod == LOD_FAR) layers.point(pos, col);
+    else layers.rect(LAYER_NODES, offsetpos, extent, vec4f(col.x, col.y, col.z, alpha));
 
-    case GRAPHVIZ:
-        float halfsize = size * 0.5f;
-        vec2f offsetpos = pos - vec2f(halfsize, halfsize);
+    layers.target(tagid, offsetpos, extent);
 
-        std::stringstream strcol;
-        strcol << "#" << setfill('0') << setw(2) << hex << (int) floor(col.x * 256) << setw(2) << (int) floor(col.y * 256) << setw(2) << (int) floor(col.z * 256);
+    if (layers.isEnabled(LAYER_BLOOM)) {
+        float bloom_radius = 50.0;
 
-        env.graphvizGraph << " [label=\"" << label
-                          << "\", height=0.2"
-                          << ", style=filled"
-                          << ", fontcolor=\"" << ((col.x+col.y+col.z > 0.5) ? "black":"white")
-                          << "\", fillcolor=\"" << strcol.str()
-                          << "\", pos=\"" << offsetpos.x << "," << offsetpos.y << "\"];\n";
-        return;
+        layers.rect(LAYER_BLOOM,
+                    pos - vec2f(bloom_radius, bloom_radius),
+                    vec2f(bloom_radius, bloom_radius) * 2,
+                    vec4f(col.x * alpha, col.y * alpha, col.z * alpha, 1.0));
     }
 
+    if (layers.labelsEnabled()) {
+        if(!label.empty()) {
+            if(shaped_label.empty()) env.labelfont.shape(label, shaped_label);
+            drawName(pos + vec2f(5,-2), env.labels, shaped_label);
+        }
 
+        if(activation_label.update(activation)) {
+            env.labelfont.shape(activation_label.c_str(), shaped_activation);
+        }
+        drawName(pos + vec2f(5,8), env.labels, shaped_activation, 0.8);
+    }
 }
 
+void NodeRenderer::toGraphViz(const vec2f& pos, MemoryView& env) {
 
-void NodeRenderer::drawSimple(const vec2f& pos){
-
-
-    glLoadName(tagid + 1); // '+1' because otherwise the node ID 0 can not be distinguished from background
-
-    glEnable(GL_BLEND);
-    glEnable(GL_TEXTURE_2D);
-
-    float ratio = icon->h / (float) icon->w;
     float halfsize = size * 0.5f;
     vec2f offsetpos = pos - vec2f(halfsize, halfsize);
 
-    glBindTexture(GL_TEXTURE_2D, getIcon()->textureid);
-
-    glPushMatrix();
-    glTranslatef(offsetpos.x, offsetpos.y, 0.0f);
-
-    col.w = 1.0;
-
-    glColor4fv(col);
-
-    glBegin(GL_QUADS);
-    glTexCoord2f(0.0f,0.0f);
-    glVertex2f(0.0f, 0.0f);
-
-    glTexCoord2f(1.0f,0.0f);
-    glVertex2f(size, 0.0f);
-
-    glTexCoord2f(1.0f,1.0f);
-    glVertex2f(size, size*ratio);
-
-    glTexCoord2f(0.0f,1.0f);
-    glVertex2f(0.0f, size*ratio);
-    glEnd();
-
-    glPopMatrix();
-
-    glLoadName(0);
+    std::stringstream strcol;
+    strcol << "#" << setfill('0') << setw(2) << hex << (int) floor(col.x * 256) << setw(2) << (int) floor(col.y * 256) << setw(2) << (int) floor(col.z * 256);
 
+    env.graphvizGraph << " [label=\"" << label
+                      << "\", height=0.2"
+                      << ", style=filled"
+                      << ", fontcolor=\"" << ((col.x+col.y+col.z > 0.5) ? "black":"white")
+                      << "\", fillcolor=\"" << strcol.str()
+                      << "\", pos=\"" << offsetpos.x << "," << offsetpos.y << "\"];\n";
 }
 
 void NodeRenderer::drawName(const vec2f& pos,
-                            FXFont& font, 
-                            string text, 
+                            TextBatch& batch,
+                            const ShapedText& text,
                             float font_scale)
 {
-
-    glPushMatrix();
-    glTranslatef(pos.x, pos.y, 0.0);
-
-    glColor4f(1.0, 1.0, 1.0, getAlpha());
-
-    vec3f screenpos = display.project(vec3f(0.0, 0.0, 0.0));
-
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    glOrtho(0, display.width, display.height, 0, -1.0, 1.0);
-
-    glMatrixMode(GL_MODELVIEW);
-    glPushMatrix();
-    glLoadIdentity();
-
-    font.setFontSize(fontsize * font_scale);
-    font.draw(screenpos.x, screenpos.y, text);
-
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-
-    glMatrixMode(GL_MODELVIEW);
-    glPopMatrix();
-
-    glPopMatrix();
-}
-
-void NodeRenderer::drawBloom(const vec2f& pos){
-
-    float bloom_radius = 50.0;
-
-    vec4f bloom_col = col;
-
-    float alpha = getAlpha();
-    glColor4f(bloom_col.x *  alpha,
-              bloom_col.y * alpha,
-              bloom_col.z * alpha,
-              1.0);
-
-    glPushMatrix();
-    glTranslatef(pos.x, pos.y, 0.0);
-
-    glBegin(GL_QUADS);
-    glTexCoord2f(1.0, 1.0);
-    glVertex2f(bloom_radius,bloom_radius);
-    glTexCoord2f(1.0, 0.0);
-    glVertex2f(bloom_radius,-bloom_radius);
-    glTexCoord2f(0.0, 0.0);
-    glVertex2f(-bloom_radius,-bloom_radius);
-    glTexCoord2f(0.0, 1.0);
-    glVertex2f(-bloom_radius,bloom_radius);
-    glEnd();
-    glPopMatrix();
-
+    batch.add(text, pos, fontsize * font_scale, vec4f(1.0, 1.0, 1.0, getAlpha()));
 }
 
-void NodeRenderer::drawShadow(const vec2f& pos){
-
-    glEnable(GL_BLEND);
-    glEnable(GL_TEXTURE_2D);
-
-    float ratio = icon->h / (float) icon->w;
-    float halfsize = size * 0.5f;
-    vec2f offsetpos = pos - vec2f(halfsize, halfsize) + SHADOW_OFFSET;;
-
-    glBindTexture(GL_TEXTURE_2D, getIcon()->textureid);
-
-    glPushMatrix();
-    glTranslatef(offsetpos.x, offsetpos.y, 0.0f);
-
-    glColor4f(0.0, 0.0, 0.0, SHADOW_STRENGTH * getAlpha());
-
-    glBegin(GL_QUADS);
-    glTexCoord2f(0.0f,0.0f);
-    glVertex2f(0.0f, 0.0f);
-
-    glTexCoord2f(1.0f,0.0f);
-    glVertex2f(size, 0.0f);
-
-    glTexCoord2f(1.0f,1.0f);
-    glVertex2f(size, size*ratio);
-
-    glTexCoord2f(0.0f,1.0f);
-    glVertex2f(0.0f, size*ratio);
-    glEnd();
-
-    glPopMatrix();
-
-}
-
-
 void NodeRenderer::setMouseOver(bool over) {
     hovered = over;
 
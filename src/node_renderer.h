@@ -23,7 +23,10 @@
 #include "constants.h"
 #include "core/vectors.h"
 #include "core/texture.h"
+#include "core/glyphatlas.h"
 #include "zoomcamera.h"
+#include "fixed_label.h"
+#include "render_layers.h"
 
 class MemoryView;
 
@@ -34,15 +37,19 @@ class NodeRenderer
 
     std::string label;
 
+    // labels are laid out once against the label atlas, and only
+    // re-shaped when their text changes
+    ShapedText shaped_label;
+    ShapedText shaped_activation;
+    FixedLabel activation_label;
+
     int tagid;
 
-    TextureResource* icon;
+    // sprite of the node, in the texture atlas
+    const TextureRegion* icon;
 
     float getAlpha();
 
-
-    TextureResource* getIcon() { return icon; }
-
     bool hovered;
     bool selected;
 
@@ -55,10 +62,7 @@ class NodeRenderer
 
     void computeSize();
 
-    void drawSimple(const vec2f& pos);
-    void drawName(const vec2f& pos, FXFont& font, std::string text, float font_scale = 1.0);
-    void drawBloom(const vec2f& pos);
-    void drawShadow(const vec2f& pos);
+    void drawName(const vec2f& pos, TextBatch& batch, const ShapedText& text, float font_scale = 1.0);
 
 
 public:
@@ -71,7 +75,17 @@ public:
 
     double activation;
 
-    void draw(const vec2f& pos, rendering_mode mode, MemoryView& env, int distance_to_selected = -1);
+    // colour of the activation, from ACTIVATION_COLOURS
+    vec4f activation_col;
+
+    /** Adds the node, its shadow, bloom and labels to the layers of the
+     * frame, and registers it as a picking target.
+     */
+    void build(const vec2f& pos, RenderLayers& layers, MemoryView& env);
+
+    /** Writes the node attributes to env.graphvizGraph, in dot format
+     */
+    void toGraphViz(const vec2f& pos, MemoryView& env);
 
     /**
     If the node is not selected, will increment the idle time of this
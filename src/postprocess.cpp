@@ -0,0 +1,330 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+
+#include "core/shader.h"
+
+#include "macros.h"
+#include "styles.h"
+#include "postprocess.h"
+
+using namespace std;
+
+#ifdef SDLAPP_SHADER_SUPPORT
+
+// the bloom buffers are 1/BLOOM_DOWNSAMPLE of the screen resolution
+static const int BLOOM_DOWNSAMPLE = 4;
+// number of (horizontal + vertical) blur passes. More passes give a wider
+// glow.
+static const int BLOOM_BLUR_PASSES = 2;
+
+// Averages 4x4 texels with 4 bilinear taps, and keeps what is above the
+// threshold. Colours are premultiplied by alpha.
+static const char* BRIGHTPASS_SHADER =
+    "uniform sampler2D tex;\n"
+    "uniform vec2 texel;\n"
+    "uniform float threshold;\n"
+    "void main() {\n"
+    "    vec2 uv = gl_TexCoord[0].xy;\n"
+    "    vec4 c = texture2D(tex, uv + vec2(-texel.x, -texel.y))\n"
+    "           + texture2D(tex, uv + vec2( texel.x, -texel.y))\n"
+    "           + texture2D(tex, uv + vec2(-texel.x,  texel.y))\n"
+    "           + texture2D(tex, uv + vec2( texel.x,  texel.y));\n"
+    "    c *= 0.25;\n"
+    "    gl_FragColor = vec4(max(c.rgb - vec3(threshold), vec3(0.0)), c.a);\n"
+    "}\n";
+
+// One direction of a 9-tap separable Gaussian blur
+static const char* BLUR_SHADER =
+    "uniform sampler2D tex;\n"
+    "uniform vec2 direction;\n"
+    "void main() {\n"
+    "    vec2 uv = gl_TexCoord[0].xy;\n"
+    "    vec4 c = texture2D(tex, uv) * 0.2270270270;\n"
+    "    c += (texture2D(tex, uv + direction) + texture2D(tex, uv - direction)) * 0.1945945946;\n"
+    "    c += (texture2D(tex, uv + 2.0 * direction) + texture2D(tex, uv - 2.0 * direction)) * 0.1216216216;\n"
+    "    c += (texture2D(tex, uv + 3.0 * direction) + texture2D(tex, uv - 3.0 * direction)) * 0.0540540541;\n"
+    "    c += (texture2D(tex, uv + 4.0 * direction) + texture2D(tex, uv - 4.0 * direction)) * 0.0162162162;\n"
+    "    gl_FragColor = c;\n"
+    "}\n";
+
+#endif
+
+PostProcess::PostProcess() :
+    enabled(false),
+    width(0),
+    height(0),
+    bloom_width(0),
+    bloom_height(0),
+    bloom_threshold(0.0),
+    bloom_intensity(1.0)
+{
+#ifdef SDLAPP_SHADER_SUPPORT
+    nodes_fbo = nodes_tex = 0;
+    bloom_fbo[0] = bloom_fbo[1] = 0;
+    bloom_tex[0] = bloom_tex[1] = 0;
+    brightpass_program = blur_program = 0;
+#endif
+}
+
+PostProcess::~PostProcess() {
+    release();
+}
+
+void PostProcess::release() {
+
+#ifdef SDLAPP_SHADER_SUPPORT
+    if (nodes_fbo) glDeleteFramebuffers(1, &nodes_fbo);
+    if (nodes_tex) glDeleteTextures(1, &nodes_tex);
+
+    for (int i = 0; i < 2; i++) {
+        if (bloom_fbo[i]) glDeleteFramebuffers(1, &bloom_fbo[i]);
+        if (bloom_tex[i]) glDeleteTextures(1, &bloom_tex[i]);
+        bloom_fbo[i] = bloom_tex[i] = 0;
+    }
+
+    if (brightpass_program) glDeleteProgram(brightpass_program);
+    if (blur_program) glDeleteProgram(blur_program);
+
+    nodes_fbo = nodes_tex = 0;
+    brightpass_program = blur_program = 0;
+#endif
+
+    enabled = false;
+}
+
+void PostProcess::init(float bloom_threshold, float bloom_intensity) {
+
+    release();
+
+    this->bloom_threshold = bloom_threshold;
+    this->bloom_intensity = bloom_intensity;
+
+#ifdef SDLAPP_SHADER_SUPPORT
+    if (!gShadersEnabled || !GLEW_VERSION_2_0 || !GLEW_ARB_framebuffer_object) {
+        debugLog("shaders or framebuffer objects not supported: using per-node bloom and shadows\n");
+        return;
+    }
+
+    width = display.width;
+    height = display.height;
+
+    bloom_width = max(1, width / BLOOM_DOWNSAMPLE);
+    bloom_height = max(1, height / BLOOM_DOWNSAMPLE);
+
+    brightpass_program = createFragmentProgram(BRIGHTPASS_SHADER);
+    blur_program = createFragmentProgram(BLUR_SHADER);
+
+    if (!brightpass_program
+        || !blur_program
+        || !createTarget(width, height, nodes_fbo, nodes_tex)
+        || !createTarget(bloom_width, bloom_height, bloom_fbo[0], bloom_tex[0])
+        || !createTarget(bloom_width, bloom_height, bloom_fbo[1], bloom_tex[1])) {
+
+        debugLog("failed to setup post-processing: using per-node bloom and shadows\n");
+        release();
+        return;
+    }
+
+    TRACE("Screen-space bloom and shadows enabled");
+    enabled = true;
+#endif
+}
+
+#ifdef SDLAPP_SHADER_SUPPORT
+
+bool PostProcess::createTarget(int w, int h, GLuint& fbo, GLuint& tex) {
+
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+
+    GLint previous_fbo;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous_fbo);
+
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, 0);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, previous_fbo);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        debugLog("offscreen framebuffer incomplete (0x%x)\n", status);
+        return false;
+    }
+
+    return true;
+}
+
+void PostProcess::drawFullscreen(GLuint texture, const vec2f& offset) {
+
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(0.0, 1.0, 0.0, 1.0, -1.0, 1.0);
+
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    glBegin(GL_QUADS);
+    glTexCoord2f(0.0f, 0.0f);
+    glVertex2f(offset.x, offset.y);
+    glTexCoord2f(1.0f, 0.0f);
+    glVertex2f(offset.x + 1.0f, offset.y);
+    glTexCoord2f(1.0f, 1.0f);
+    glVertex2f(offset.x + 1.0f, offset.y + 1.0f);
+    glTexCoord2f(0.0f, 1.0f);
+    glVertex2f(offset.x, offset.y + 1.0f);
+    glEnd();
+
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+}
+
+void PostProcess::renderNodes(RenderLayers& layers) {
+
+    GLint previous_fbo;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous_fbo);
+
+    GLfloat clear_colour[4];
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clear_colour);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, nodes_fbo);
+
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    // the texture is premultiplied by alpha, so that it can be composited
+    // over the scene
+    glEnable(GL_BLEND);
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    layers.drawFadedNodes();
+
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, previous_fbo);
+    glClearColor(clear_colour[0], clear_colour[1], clear_colour[2], clear_colour[3]);
+}
+
+void PostProcess::renderBloom() {
+
+    GLint previous_fbo;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous_fbo);
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    glViewport(0, 0, bloom_width, bloom_height);
+    glDisable(GL_BLEND);
+    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+
+    // bright-pass and downsample
+    glBindFramebuffer(GL_FRAMEBUFFER, bloom_fbo[0]);
+    glUseProgram(brightpass_program);
+    glUniform1i(glGetUniformLocation(brightpass_program, "tex"), 0);
+    glUniform2f(glGetUniformLocation(brightpass_program, "texel"), 1.0f / width, 1.0f / height);
+    glUniform1f(glGetUniformLocation(brightpass_program, "threshold"), bloom_threshold);
+    drawFullscreen(nodes_tex);
+
+    // blur, ping-ponging between the two buffers
+    glUseProgram(blur_program);
+    glUniform1i(glGetUniformLocation(blur_program, "tex"), 0);
+    GLint direction = glGetUniformLocation(blur_program, "direction");
+
+    for (int i = 0; i < BLOOM_BLUR_PASSES; i++) {
+        glBindFramebuffer(GL_FRAMEBUFFER, bloom_fbo[1]);
+        glUniform2f(direction, 1.0f / bloom_width, 0.0f);
+        drawFullscreen(bloom_tex[0]);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, bloom_fbo[0]);
+        glUniform2f(direction, 0.0f, 1.0f / bloom_height);
+        drawFullscreen(bloom_tex[1]);
+    }
+
+    glUseProgram(0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, previous_fbo);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glEnable(GL_BLEND);
+}
+
+#endif
+
+void PostProcess::draw(RenderLayers& layers, bool shadows, bool bloom) {
+
+#ifdef SDLAPP_SHADER_SUPPORT
+    if (!enabled) return;
+
+    // shadow offset, from world units to texture coordinates
+    GLint viewport[4];
+    GLdouble modelview[16];
+    GLdouble projection[16];
+    GLdouble x0, y0, x1, y1, z;
+
+    glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
+    glGetDoublev(GL_PROJECTION_MATRIX, projection);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    gluProject(0.0, 0.0, 0.0, modelview, projection, viewport, &x0, &y0, &z);
+    gluProject(SHADOW_OFFSET.x, SHADOW_OFFSET.y, 0.0, modelview, projection, viewport, &x1, &y1, &z);
+
+    vec2f shadow_offset((x1 - x0) / width, (y1 - y0) / height);
+
+    renderNodes(layers);
+    if (bloom) renderBloom();
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    if (layers.isEnabled(LAYER_EDGE_SHADOWS)) layers.drawLayer(LAYER_EDGE_SHADOWS);
+
+    if (shadows) {
+        // the texture colour is modulated to black
+        glColor4f(0.0f, 0.0f, 0.0f, SHADOW_STRENGTH);
+        drawFullscreen(nodes_tex, shadow_offset);
+    }
+
+    layers.drawLayer(LAYER_EDGES);
+
+    // the texture holds the faded nodes: the nodes themselves are drawn
+    // from the layer
+    layers.drawLayer(LAYER_NODES);
+
+    if (bloom) {
+        glBlendFunc(GL_ONE, GL_ONE);
+        glColor4f(bloom_intensity, bloom_intensity, bloom_intensity, 1.0f);
+        drawFullscreen(bloom_tex[0]);
+    }
+
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+#endif
+}
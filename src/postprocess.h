@@ -0,0 +1,88 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef POSTPROCESS_H
+#define POSTPROCESS_H
+
+#include "core/display.h"
+
+#include "render_layers.h"
+
+/**
+ * Screen-space bloom and node shadows.
+ *
+ * The node layer, with the idle fade of each node (see RenderLayers), is
+ * rendered once into an offscreen texture. Node shadows are then a single
+ * offset, tinted copy of that texture, and the bloom is a bright-pass of it,
+ * downsampled to a quarter of the resolution and blurred with a separable
+ * Gaussian filter. Their cost depends on the resolution, not on the number
+ * of nodes.
+ *
+ * Only available with SDLAPP_SHADER_SUPPORT, when shaders and framebuffer
+ * objects are supported: otherwise, isEnabled() returns false and the
+ * per-node bloom and shadow layers are used instead.
+ */
+class PostProcess {
+
+    bool enabled;
+
+    int width, height;
+    int bloom_width, bloom_height;
+
+    float bloom_threshold;
+    float bloom_intensity;
+
+#ifdef SDLAPP_SHADER_SUPPORT
+    // node layer, full resolution
+    GLuint nodes_fbo, nodes_tex;
+
+    // bloom ping-pong buffers, quarter resolution
+    GLuint bloom_fbo[2], bloom_tex[2];
+
+    GLuint brightpass_program;
+    GLuint blur_program;
+
+    bool createTarget(int w, int h, GLuint& fbo, GLuint& tex);
+
+    void drawFullscreen(GLuint texture, const vec2f& offset = vec2f(0.0, 0.0));
+
+    void renderNodes(RenderLayers& layers);
+    void renderBloom();
+#endif
+
+    void release();
+
+public:
+    PostProcess();
+    ~PostProcess();
+
+    /** Allocates the offscreen buffers and compiles the shaders, for the
+     * current display size. Leaves the post-processing disabled if anything
+     * is not supported.
+     */
+    void init(float bloom_threshold = 0.0, float bloom_intensity = 1.0);
+
+    bool isEnabled() const {return enabled;}
+
+    /** Draws the layers, replacing the per-node shadows and bloom
+     * (LAYER_NODE_SHADOWS and LAYER_BLOOM are never drawn) by their
+     * screen-space version.
+     */
+    void draw(RenderLayers& layers, bool shadows, bool bloom);
+};
+
+#endif // POSTPROCESS_H
@@ -0,0 +1,178 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "render_layers.h"
+
+using namespace std;
+
+RenderLayers::RenderLayers() :
+    texture(0),
+    labels_enabled(true)
+{
+    for (int i = 0; i < LAYER_COUNT; i++) {
+        enabled[i] = true;
+    }
+}
+
+void RenderLayers::clear() {
+    for (auto& layer : layers) layer.clear();
+    points.clear();
+    targets.clear();
+}
+
+void RenderLayers::enable(render_layer layer, bool enable) {
+    enabled[layer] = enable;
+}
+
+void RenderLayers::setTexture(GLuint texture) {
+    this->texture = texture;
+}
+
+void RenderLayers::setSprite(render_layer layer, const TextureRegion& sprite) {
+    sprites[layer] = sprite;
+}
+
+void RenderLayers::vertex(render_layer layer, const vec2f& pos, float u, float v, const vec4f& col) {
+    const TextureRegion& sprite = sprites[layer];
+
+    layers[layer].push_back({pos.x, pos.y, sprite.u(u), sprite.v(v), col.x, col.y, col.z, col.w});
+}
+
+void RenderLayers::rect(render_layer layer, const vec2f& corner, const vec2f& extent, const vec4f& col) {
+
+    auto& vertices = layers[layer];
+    const TextureRegion& sprite = sprites[layer];
+
+    float x0 = corner.x, y0 = corner.y;
+    float x1 = corner.x + extent.x, y1 = corner.y + extent.y;
+
+    vertices.push_back({x0, y0, sprite.u0, sprite.v0, col.x, col.y, col.z, col.w});
+    vertices.push_back({x1, y0, sprite.u1, sprite.v0, col.x, col.y, col.z, col.w});
+    vertices.push_back({x1, y1, sprite.u1, sprite.v1, col.x, col.y, col.z, col.w});
+    vertices.push_back({x0, y1, sprite.u0, sprite.v1, col.x, col.y, col.z, col.w});
+}
+
+void RenderLayers::point(const vec2f& pos, const vec4f& col) {
+    points.push_back({pos.x, pos.y, 0.0f, 0.0f, col.x, col.y, col.z, col.w});
+}
+
+void RenderLayers::target(int id, const vec2f& corner, const vec2f& extent) {
+    targets.push_back({id, corner.x, corner.y, corner.x + extent.x, corner.y + extent.y});
+}
+
+int RenderLayers::pick(const vec2f& screenpos) const {
+
+    if (targets.empty()) return -1;
+
+    vec2f pos;
+    if (!display.unprojectOnPlane(screenpos, pos)) return -1;
+
+    float x = pos.x, y = pos.y;
+
+    // last drawn is topmost
+    for (auto it = targets.rbegin(); it != targets.rend(); ++it) {
+        if (x >= it->x0 && x <= it->x1 && y >= it->y0 && y <= it->y1) return it->id;
+    }
+
+    return -1;
+}
+
+void RenderLayers::submit(const vector<Vertex>& vertices, GLenum primitive) {
+
+    if (vertices.empty()) return;
+
+    glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &vertices[0].x);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &vertices[0].u);
+    glColorPointer(4, GL_FLOAT, sizeof(Vertex), &vertices[0].r);
+
+    glDrawArrays(primitive, 0, vertices.size());
+}
+
+void RenderLayers::drawNodes(bool faded) {
+
+    if (!faded) {
+        // rgb modulated by the vertex colour, alpha from the sprite only
+        glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
+        glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
+        glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_TEXTURE);
+        glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_PRIMARY_COLOR);
+        glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_REPLACE);
+        glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_TEXTURE);
+    }
+
+    submit(layers[LAYER_NODES], GL_QUADS);
+
+    if (!faded) glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
+    if (!points.empty()) {
+        glDisable(GL_TEXTURE_2D);
+        submit(points, GL_POINTS);
+        glEnable(GL_TEXTURE_2D);
+    }
+}
+
+void RenderLayers::drawFadedNodes() {
+
+    glEnable(GL_TEXTURE_2D);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    drawNodes(true);
+
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+void RenderLayers::drawLayer(render_layer layer) {
+
+    glEnable(GL_TEXTURE_2D);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    if (layer == LAYER_NODES) drawNodes(false);
+    else submit(layers[layer], GL_QUADS);
+
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+void RenderLayers::draw() {
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    for (int i = 0; i < LAYER_COUNT; i++) {
+        auto layer = (render_layer) i;
+
+        if (!enabled[layer]) continue;
+
+        if (layer == LAYER_BLOOM) glBlendFunc(GL_ONE, GL_ONE);
+
+        drawLayer(layer);
+    }
+
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
@@ -0,0 +1,145 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef RENDER_LAYERS_H
+#define RENDER_LAYERS_H
+
+#include <vector>
+
+#include "core/display.h"
+#include "core/texture.h"
+#include "core/vectors.h"
+
+/** The layers of the graph rendering, in the order they are submitted.
+ * Nodes drawn as points (LOD_FAR) are submitted right after LAYER_NODES.
+ *
+ * The vertex alpha of LAYER_NODES is the idle fade of the node, which only
+ * applies to its shadow and bloom (see drawFadedNodes()): nodes themselves
+ * are drawn with the alpha of their sprite.
+ */
+enum render_layer {LAYER_EDGE_SHADOWS,
+                   LAYER_NODE_SHADOWS,
+                   LAYER_EDGES,
+                   LAYER_NODES,
+                   LAYER_BLOOM,
+                   LAYER_COUNT};
+
+/**
+ * Vertex lists of one frame of the graph, filled by a single traversal of
+ * the nodes and edges, then submitted layer by layer, each with its own
+ * blending (one glDrawArrays per layer). All the layers share the sprite
+ * atlas of the texture manager: there is no texture switch between them.
+ *
+ * The lists keep their capacity from one frame to the next, so that
+ * building a frame does not allocate.
+ *
+ * The traversal also records the on-screen quad of each node, which is used
+ * for picking the node under the mouse.
+ */
+class RenderLayers {
+
+    struct Vertex {
+        float x, y;
+        float u, v;
+        float r, g, b, a;
+    };
+
+    struct Target {
+        int id;
+        float x0, y0, x1, y1;
+    };
+
+    std::vector<Vertex> layers[LAYER_COUNT];
+    std::vector<Vertex> points;
+
+    bool enabled[LAYER_COUNT];
+
+    // all layers are drawn from the same texture atlas, each with its own
+    // sprite
+    GLuint texture;
+    TextureRegion sprites[LAYER_COUNT];
+
+    bool labels_enabled;
+
+    std::vector<Target> targets;
+
+    void submit(const std::vector<Vertex>& vertices, GLenum primitive);
+    void drawNodes(bool faded);
+
+public:
+    RenderLayers();
+
+    /** Empties all the layers and the picking targets.
+     */
+    void clear();
+
+    void enable(render_layer layer, bool enable);
+    bool isEnabled(render_layer layer) const {return enabled[layer];}
+
+    /** Labels are batched separately (cf TextBatch). The flag only tells
+     * the traversal whether it should add them.
+     */
+    void enableLabels(bool enable) {labels_enabled = enable;}
+    bool labelsEnabled() const {return labels_enabled;}
+
+    void setTexture(GLuint texture);
+    void setSprite(render_layer layer, const TextureRegion& sprite);
+
+    /** Adds one vertex to a layer. Layers are drawn as GL_QUADS: vertices
+     * must be added four by four.
+     *
+     * (u, v) are texture coordinates within the sprite of the layer.
+     */
+    void vertex(render_layer layer, const vec2f& pos, float u, float v, const vec4f& col);
+
+    /** Adds an axis-aligned textured quad, from 'corner' to 'corner + extent'.
+     */
+    void rect(render_layer layer, const vec2f& corner, const vec2f& extent, const vec4f& col);
+
+    /** Adds an untextured point, drawn with the current point size.
+     */
+    void point(const vec2f& pos, const vec4f& col);
+
+    /** Records the quad of a pickable node.
+     */
+    void target(int id, const vec2f& corner, const vec2f& extent);
+
+    /** Returns the id of the topmost node under a screen position (or -1
+     * if none), using the current modelview and projection matrices to
+     * unproject the position onto the graph plane (z = 0).
+     *
+     * Targets are the ones recorded by the last traversal.
+     */
+    int pick(const vec2f& screenpos) const;
+
+    /** Submits one layer, even if disabled, with the current blending.
+     * LAYER_NODES includes the points.
+     */
+    void drawLayer(render_layer layer);
+
+    /** Submits LAYER_NODES with the idle fade of each node applied to its
+     * alpha, as the source of screen-space shadows and bloom.
+     */
+    void drawFadedNodes();
+
+    /** Submits all the enabled layers. Leaves the blending to
+     * GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA.
+     */
+    void draw();
+};
+
+#endif // RENDER_LAYERS_H
@@ -0,0 +1,82 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ros_ingest.h"
+
+using namespace std;
+
+RosIngest::RosIngest(MemoryNetwork& memory, const ros::NodeHandle& nh) :
+    AttentionIngest(memory),
+    nh(nh),
+    spinner(1, &queue),
+    subscriber_queue_size(100),
+    lost_messages(0)
+{
+    this->nh.setCallbackQueue(&queue);
+}
+
+RosIngest::~RosIngest() {
+    stop();
+}
+
+void RosIngest::setSubscriberQueueSize(int subscriber_queue_size) {
+    this->subscriber_queue_size = subscriber_queue_size;
+}
+
+void RosIngest::start() {
+
+    attention_targets = nh.subscribe("attention_targets", subscriber_queue_size, &RosIngest::on_attention_target, this);
+
+    drain_timer = nh.createWallTimer(ros::WallDuration(window), &RosIngest::on_drain_timer, this);
+
+    spinner.start();
+}
+
+void RosIngest::stop() {
+    spinner.stop();
+    drain_timer.stop();
+}
+
+void RosIngest::on_attention_target(const ros::MessageEvent<playground_builder::AttentionTargetsStamped const>& event) {
+
+    const playground_builder::AttentionTargetsStamped::ConstPtr& msg = event.getConstMessage();
+
+    // sequence numbers are assigned per publisher, whatever the frame_id
+    auto last = last_seq.find(event.getPublisherName());
+    if (last == last_seq.end()) {
+        last_seq.emplace(event.getPublisherName(), msg->header.seq);
+    }
+    else {
+        // a smaller sequence number is a restarted publisher, not a loss
+        if (msg->header.seq > last->second + 1) lost_messages += msg->header.seq - last->second - 1;
+        last->second = msg->header.seq;
+    }
+
+    // header stamps are expected to be wall-clock times (no simulated time)
+    received(msg->header.stamp.isZero() ? 0 : msg->header.stamp.toNSec() / 1000);
+
+    // the unit corresponding to current user
+    target(msg->header.frame_id, 1.0);
+
+    for (const auto& t : msg->targets) {
+        target(t.frame_id, t.intensity);
+    }
+}
+
+void RosIngest::on_drain_timer(const ros::WallTimerEvent& event) {
+    drain();
+}
@@ -0,0 +1,80 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ROS_INGEST_H
+#define ROS_INGEST_H
+
+#include <atomic>
+#include <string>
+#include <unordered_map>
+
+#include <ros/ros.h>
+#include <ros/callback_queue.h>
+#include <playground_builder/AttentionTargetsStamped.h>
+
+#include "attention_ingest.h"
+
+/**
+ * Receives the attention targets from the 'attention_targets' topic.
+ *
+ * Subscriptions are served from a dedicated callback queue, by their own
+ * spinner thread, independently of the frame rate. The queued targets are
+ * drained by a timer on the same queue, hence in the same thread.
+ *
+ * Messages dropped by the subscriber queue are counted from the gaps in the
+ * header sequence numbers, per publisher. roscpp only fills the sequence
+ * numbers when a message is serialized: losses are not detected for
+ * intra-process (eg, nodelet) publishers.
+ */
+class RosIngest : public AttentionIngest {
+
+    ros::NodeHandle nh;
+    ros::CallbackQueue queue;
+    ros::AsyncSpinner spinner;
+
+    ros::Subscriber attention_targets;
+    ros::WallTimer drain_timer;
+
+    int subscriber_queue_size;
+
+    // last header sequence number, per publisher (caller id)
+    std::unordered_map<std::string, uint32_t> last_seq;
+    std::atomic<uint64_t> lost_messages;
+
+    void on_attention_target(const ros::MessageEvent<playground_builder::AttentionTargetsStamped const>& event);
+    void on_drain_timer(const ros::WallTimerEvent& event);
+
+public:
+    /** Subscribes in the namespace of 'nh' (served from the own callback
+     * queue of the ingestion anyway)
+     */
+    RosIngest(MemoryNetwork& memory, const ros::NodeHandle& nh = ros::NodeHandle());
+    ~RosIngest();
+
+    /** Depth of the ROS subscriber queue. Must be called before start().
+     */
+    void setSubscriberQueueSize(int subscriber_queue_size);
+
+    /** Subscribes to the attention targets and starts the spinner thread
+     */
+    void start() override;
+    void stop() override;
+
+    uint64_t lostMessages() const override {return lost_messages;}
+};
+
+#endif // ROS_INGEST_H
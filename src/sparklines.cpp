@@ -0,0 +1,249 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+
+#include "sparklines.h"
+
+using namespace std;
+
+Sparklines::Sparklines(size_t length) :
+    length(length),
+    vbo(0),
+    vbo_plots(0),
+    first_row(0)
+{
+}
+
+Sparklines::~Sparklines() {
+#ifdef SDLAPP_SHADER_SUPPORT
+    if (vbo) glDeleteBuffers(1, &vbo);
+#endif
+}
+
+void Sparklines::init() {
+
+#ifdef SDLAPP_SHADER_SUPPORT
+    if (gShadersEnabled && GLEW_ARB_vertex_buffer_object) {
+        glGenBuffers(1, &vbo);
+    }
+#endif
+}
+
+void Sparklines::setUnits(const vector<size_t>& units,
+                          const vector<string>& names,
+                          const GlyphAtlas& font) {
+
+    bool changed = units.size() != plots.size();
+
+    for (size_t p = 0; p < units.size(); p++) {
+
+        if (p < plots.size() && plots[p].unit == units[p]) continue;
+
+        changed = true;
+
+        if (p >= plots.size()) plots.push_back(Plot());
+
+        plots[p].unit = units[p];
+        plots[p].uploaded = 0;
+        font.shape(names[p], plots[p].title);
+    }
+
+    if (!changed) return;
+
+    plots.resize(units.size());
+
+    // x of the vertices is their slot
+    size_t previous = vertices.size() / 2;
+    vertices.resize(plots.size() * length * 2);
+    for (size_t i = previous; i < plots.size() * length; i++) {
+        vertices[i * 2] = i % length;
+        vertices[i * 2 + 1] = 0.0f;
+    }
+}
+
+void Sparklines::upload(size_t first_vertex, size_t count) {
+
+#ifdef SDLAPP_SHADER_SUPPORT
+    if (!vbo || count == 0) return;
+
+    glBufferSubData(GL_ARRAY_BUFFER,
+                    first_vertex * 2 * sizeof(float),
+                    count * 2 * sizeof(float),
+                    &vertices[first_vertex * 2]);
+#endif
+}
+
+void Sparklines::update(const ActivationHistory& history) {
+
+    if (plots.empty()) return;
+
+    bool reallocate = false;
+
+#ifdef SDLAPP_SHADER_SUPPORT
+    if (vbo) {
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+        // the whole buffer is sent below
+        if (vbo_plots < plots.size()) reallocate = true;
+    }
+#endif
+
+    for (size_t p = 0; p < plots.size(); p++) {
+        Plot& plot = plots[p];
+
+        uint64_t count = history.read(plot.unit, plot.uploaded, values);
+        uint64_t first = count - values.size();
+
+        size_t base = p * length;
+
+        for (size_t k = 0; k < values.size(); k++) {
+            vertices[(base + (first + k) % length) * 2 + 1] = values[k];
+        }
+
+        plot.uploaded = count;
+
+        if (reallocate || values.empty()) continue;
+
+        // the new samples cover at most two runs of slots
+        size_t from = first % length;
+        size_t run = min(values.size(), length - from);
+
+        upload(base + from, run);
+        upload(base, values.size() - run);
+    }
+
+#ifdef SDLAPP_SHADER_SUPPORT
+    if (reallocate) {
+        vbo_plots = plots.size();
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), &vertices[0], GL_DYNAMIC_DRAW);
+    }
+
+    if (vbo) glBindBuffer(GL_ARRAY_BUFFER, 0);
+#endif
+}
+
+void Sparklines::scroll(int rows) {
+    first_row = max(0, first_row + rows);
+}
+
+void Sparklines::draw(const GlyphAtlas& font, float x, float y, float width, float height, float amin) {
+
+    if (plots.empty()) return;
+
+    int cell_width = PLOT_WIDTH + MARGIN;
+    int cell_height = TITLE_HEIGHT + PLOT_HEIGHT + MARGIN;
+
+    int columns = max(1, (int) (width / cell_width));
+    int visible_rows = max(1, (int) (height / cell_height));
+    int rows = (plots.size() + columns - 1) / columns;
+
+    first_row = min(first_row, max(0, rows - visible_rows));
+
+    size_t first_plot = first_row * columns;
+    size_t last_plot = min(plots.size(), (size_t) (first_row + visible_rows) * columns);
+
+    // activations from amin to 1 cover the height of the plot
+    float scale = PLOT_HEIGHT / (1.0f - amin);
+
+    frames.clear();
+    zero_lines.clear();
+
+    titles.begin(font);
+
+    for (size_t p = first_plot; p < last_plot; p++) {
+        float x0 = x + ((p - first_plot) % columns) * cell_width;
+        float y0 = y + ((p - first_plot) / columns) * cell_height + TITLE_HEIGHT;
+        float x1 = x0 + PLOT_WIDTH;
+        float y1 = y0 + PLOT_HEIGHT;
+
+        float frame[] = {x0, y0, x1, y0,  x1, y0, x1, y1,  x1, y1, x0, y1,  x0, y1, x0, y0};
+        frames.insert(frames.end(), frame, frame + 16);
+
+        float zero[] = {x0, y0 + scale, x1, y0 + scale};
+        zero_lines.insert(zero_lines.end(), zero, zero + 4);
+
+        titles.add(plots[p].title, vec2f(x0, y0 - TITLE_HEIGHT), BASE_FONT_SIZE, vec4f(0.0f, 0.0f, 0.0f, 1.0f));
+    }
+
+    glDisable(GL_TEXTURE_2D);
+    glEnableClientState(GL_VERTEX_ARRAY);
+
+    glColor4f(0.f, .1f, 0.1f, .6f);
+    glVertexPointer(2, GL_FLOAT, 0, &frames[0]);
+    glDrawArrays(GL_LINES, 0, frames.size() / 2);
+
+    glColor4f(0.f, 1.f, 0.2f, .6f);
+    glVertexPointer(2, GL_FLOAT, 0, &zero_lines[0]);
+    glDrawArrays(GL_LINES, 0, zero_lines.size() / 2);
+
+    // the plots themselves, from the vertex buffer
+    const float* pointer = &vertices[0];
+
+#ifdef SDLAPP_SHADER_SUPPORT
+    if (vbo) {
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        pointer = 0;
+    }
+#endif
+
+    glVertexPointer(2, GL_FLOAT, 0, pointer);
+
+    glColor4f(1.f, .2f, 0.2f, 1.f);
+
+    for (size_t p = first_plot; p < last_plot; p++) {
+        const Plot& plot = plots[p];
+
+        if (plot.uploaded == 0) continue;
+
+        float x0 = x + ((p - first_plot) % columns) * cell_width;
+        float y0 = y + ((p - first_plot) / columns) * cell_height + TITLE_HEIGHT;
+
+        size_t base = p * length;
+        size_t head = plot.uploaded % length;
+
+        glPushMatrix();
+        glTranslatef(x0, y0 + scale, 0.0f);
+        glScalef((float) PLOT_WIDTH / length, -scale, 1.0f);
+
+        // oldest samples, from the head to the end of the ring (only
+        // recorded once the ring has been filled)
+        if (plot.uploaded >= length && head < length) {
+            glPushMatrix();
+            glTranslatef(-(float) head, 0.0f, 0.0f);
+            glDrawArrays(GL_LINE_STRIP, base + head, length - head);
+            glPopMatrix();
+        }
+
+        // most recent samples, from the start of the ring to the head
+        if (head > 0) {
+            glTranslatef(length - head, 0.0f, 0.0f);
+            glDrawArrays(GL_LINE_STRIP, base, head);
+        }
+
+        glPopMatrix();
+    }
+
+#ifdef SDLAPP_SHADER_SUPPORT
+    if (vbo) glBindBuffer(GL_ARRAY_BUFFER, 0);
+#endif
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glEnable(GL_TEXTURE_2D);
+
+    titles.draw();
+}
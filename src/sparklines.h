@@ -0,0 +1,109 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SPARKLINES_H
+#define SPARKLINES_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/display.h"
+#include "core/glyphatlas.h"
+
+#include "activation_history.h"
+#include "styles.h"
+
+/**
+ * Grid of compact activity plots, one per unit, in a scrollable panel.
+ *
+ * The histories of all the plotted units are packed in a single vertex
+ * buffer (client-side arrays if vertex buffer objects are not supported).
+ * Each plot owns one vertex per history slot: x is the slot, y the
+ * activation. Vertices follow the ring of ActivationHistory, so that only
+ * the samples appended since the last frame are uploaded; the ring is then
+ * drawn as two line strips, shifted so that the latest sample is on the
+ * right.
+ */
+class Sparklines {
+
+    struct Plot {
+        size_t unit;
+        ShapedText title;
+        // number of samples of the history already in the buffer
+        uint64_t uploaded;
+    };
+
+    size_t length;
+
+    std::vector<Plot> plots;
+
+    // (slot, activation) for each slot of each plot
+    std::vector<float> vertices;
+
+    // screen-space frames and zero lines of the visible plots
+    std::vector<float> frames;
+    std::vector<float> zero_lines;
+
+    std::vector<float> values;
+
+    GLuint vbo;
+    size_t vbo_plots; // number of plots the buffer was allocated for
+
+    int first_row;
+
+    TextBatch titles;
+
+    void upload(size_t first_vertex, size_t count);
+
+public:
+    static const int PLOT_WIDTH = 150; // px
+    static const int PLOT_HEIGHT = 30; // px
+    static const int TITLE_HEIGHT = 16; // px
+    static const int MARGIN = 10; // px
+
+    Sparklines(size_t length);
+    ~Sparklines();
+
+    /** Uses a vertex buffer object if supported. Needs a GL context.
+     */
+    void init();
+
+    /** Sets the plotted units. Plots of units that were already plotted at
+     * the same place are kept.
+     */
+    void setUnits(const std::vector<size_t>& units,
+                  const std::vector<std::string>& names,
+                  const GlyphAtlas& font);
+
+    bool empty() const {return plots.empty();}
+
+    /** Fetches and uploads the samples recorded since the last update
+     */
+    void update(const ActivationHistory& history);
+
+    /** Scrolls the panel by a number of rows (negative to scroll up)
+     */
+    void scroll(int rows);
+
+    /** Draws the panel in the given screen rectangle. Activations are
+     * plotted between 'amin' and 1.
+     */
+    void draw(const GlyphAtlas& font, float x, float y, float width, float height, float amin);
+};
+
+#endif // SPARKLINES_H
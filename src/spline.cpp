@@ -67,117 +67,57 @@ SplineEdge::SplineEdge(vec2f pos1, vec4f col1, vec2f pos2, vec4f col2, vec2f spo
     }
 }
 
-void SplineEdge::drawBeam(vec2f pos1, vec4f col1, vec2f pos2, vec4f col2, float radius, bool first, bool last) {
+void SplineEdge::build(RenderLayers& layers, render_layer layer, bool shadow) const {
 
-    vec2f perp = (pos1 - pos2).perpendicular().normal() * radius;
-
-    if (first) {
-
-        if (arrow_head) {
+    int edges_count = spline_point.size() - 1;
 
-            vec2f arrow = (pos2 - pos1).normal() * ARROW_SIZE;
+    if (edges_count <= 0) return;
 
-            vec2f newpos1 = pos1 + arrow;
+    float radius = shadow ? 2.5 : 0.5;
+    vec2f offset = shadow ? SHADOW_OFFSET : vec2f(0.0, 0.0);
 
-            glEnd();
-            glBegin(GL_TRIANGLES);
-
-            glColor4fv(col1);
-            glTexCoord2f(0.0,0.0);
-            glVertex2f(newpos1.x + perp.x * 2, newpos1.y + perp.y * 2);
-            glTexCoord2f(0.5,1.0);
-            glVertex2f(pos1.x, pos1.y);
-            glTexCoord2f(1.0,0.0);
-            glVertex2f(newpos1.x - perp.x * 2, newpos1.y - perp.y * 2);
-
-            glEnd();
-            glBegin(GL_QUAD_STRIP);
-            // src point
-            glTexCoord2f(1.0,0.0);
-            glVertex2f(newpos1.x + perp.x, newpos1.y + perp.y);
-            glTexCoord2f(0.0,0.0);
-            glVertex2f(newpos1.x - perp.x, newpos1.y - perp.y);
+    // each segment starts with the perpendicular of the previous one, as
+    // the vertices of a quad strip would
+    vec2f last_perp = (spline_point[0] - spline_point[1]).perpendicular().normal() * radius;
 
-        }
-        else {
-            // src point
-            glColor4fv(col1);
-            glTexCoord2f(1.0,0.0);
-            glVertex2f(pos1.x + perp.x, pos1.y + perp.y);
-            glTexCoord2f(0.0,0.0);
-            glVertex2f(pos1.x - perp.x, pos1.y - perp.y);
-        }
-    }
+    for(int i=0;i<edges_count;i++) {
 
+        vec2f pos1 = spline_point[i] + offset;
+        vec2f pos2 = spline_point[i+1] + offset;
 
-    // dest point
-    glColor4fv(col2);
+        vec4f col1 = shadow ? vec4f(0.0, 0.0, 0.0, SHADOW_STRENGTH * spline_colour[i].w) : spline_colour[i];
+        vec4f col2 = shadow ? vec4f(0.0, 0.0, 0.0, SHADOW_STRENGTH * spline_colour[i+1].w) : spline_colour[i+1];
 
-    if (last && arrow_tail) {
+        vec2f perp = (pos1 - pos2).perpendicular().normal() * radius;
 
         vec2f arrow = (pos2 - pos1).normal() * ARROW_SIZE;
 
-        vec2f newpos2 = pos2 - arrow;
-
-        glTexCoord2f(1.0,0.0);
-        glVertex2f(newpos2.x + perp.x, newpos2.y + perp.y);
-        glTexCoord2f(0.0,0.0);
-        glVertex2f(newpos2.x - perp.x, newpos2.y - perp.y);
-        //Arrow
-        glEnd();
-        glBegin(GL_TRIANGLES);
-
-        glTexCoord2f(0.0,0.0);
-        glVertex2f(newpos2.x + perp.x * 2, newpos2.y + perp.y * 2);
-        glTexCoord2f(0.5,1.0);
-        glVertex2f(pos2.x, pos2.y);
-        glTexCoord2f(1.0,0.0);
-        glVertex2f(newpos2.x - perp.x * 2, newpos2.y - perp.y * 2);
-    }
-    else {
-        glTexCoord2f(1.0,0.0);
-        glVertex2f(pos2.x + perp.x, pos2.y + perp.y);
-        glTexCoord2f(0.0,0.0);
-        glVertex2f(pos2.x - perp.x, pos2.y - perp.y);
-    }
-}
-
-void SplineEdge::drawShadow() {
-
-    int edges_count = spline_point.size() - 1;
-
-    if (edges_count <= 0) return;
-
-    glBegin(GL_QUAD_STRIP);
-
-    for(int i=0;i<edges_count;i++) {
-        drawBeam(spline_point[i] + SHADOW_OFFSET, vec4f(0.0, 0.0, 0.0, SHADOW_STRENGTH * spline_colour[i].w),
-                 spline_point[i+1] + SHADOW_OFFSET, vec4f(0.0, 0.0, 0.0, SHADOW_STRENGTH * spline_colour[i+1].w),
-                 2.5,
-                 i == 0, // first?
-                 i == edges_count - 1 // last?
-                 );
-    }
+        if (i == 0 && arrow_head) {
+            vec2f newpos1 = pos1 + arrow;
 
-    glEnd();
-}
+            // triangles are degenerated quads
+            layers.vertex(layer, newpos1 + perp * 2, 0.0, 0.0, col1);
+            layers.vertex(layer, pos1, 0.5, 1.0, col1);
+            layers.vertex(layer, newpos1 - perp * 2, 1.0, 0.0, col1);
+            layers.vertex(layer, newpos1 - perp * 2, 1.0, 0.0, col1);
 
-void SplineEdge::draw() {
+            pos1 = newpos1;
+        }
 
-    int edges_count = spline_point.size() - 1;
+        vec2f end = (i == edges_count - 1 && arrow_tail) ? pos2 - arrow : pos2;
 
-    if (edges_count <= 0) return;
+        layers.vertex(layer, pos1 + last_perp, 1.0, 0.0, col1);
+        layers.vertex(layer, pos1 - last_perp, 0.0, 0.0, col1);
+        layers.vertex(layer, end - perp, 0.0, 0.0, col2);
+        layers.vertex(layer, end + perp, 1.0, 0.0, col2);
 
-    glBegin(GL_QUAD_STRIP);
+        if (i == edges_count - 1 && arrow_tail) {
+            layers.vertex(layer, end + perp * 2, 0.0, 0.0, col2);
+            layers.vertex(layer, pos2, 0.5, 1.0, col2);
+            layers.vertex(layer, end - perp * 2, 1.0, 0.0, col2);
+            layers.vertex(layer, end - perp * 2, 1.0, 0.0, col2);
+        }
 
-    for(int i=0;i<edges_count;i++) {
-        drawBeam(spline_point[i], spline_colour[i],
-                 spline_point[i+1], spline_colour[i+1],
-                 0.5,
-                 i == 0, //first?
-                 i == edges_count - 1 //last?
-                 );
+        last_perp = perp;
     }
-
-    glEnd();
 }
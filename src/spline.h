@@ -22,6 +22,8 @@
 #include "core/vectors.h"
 #include "core/pi.h"
 
+#include "render_layers.h"
+
 #include <vector>
 
 class SplineEdge {
@@ -34,7 +36,6 @@ class SplineEdge {
     // if true, ends the spline with an arrow
     bool arrow_tail;
 
-    void drawBeam(vec2f pos1, vec4f col1, vec2f pos2, vec4f col2, float radius, bool first, bool last);
 public:
     SplineEdge();
     SplineEdge(vec2f pos1, vec4f col1,
@@ -43,8 +44,9 @@ public:
                bool arrow_head = false,
                bool arrow_tail = false);
 
-    void drawShadow();
-    void draw();
+    /** Adds the quads of the spline (or of its shadow) to a layer.
+     */
+    void build(RenderLayers& layers, render_layer layer, bool shadow = false) const;
 };
 
 #endif
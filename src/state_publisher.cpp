@@ -0,0 +1,210 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "state_publisher.h"
+
+using namespace std;
+
+// messages of each topic in flight at the same time (in the publisher
+// queue, or held by subscribers)
+static const size_t POOL_SIZE = 4;
+
+StatePublisher::StatePublisher(MemoryNetwork& memory, const ros::NodeHandle& nh) :
+    memory(memory),
+    nh(nh),
+    rate(10.0),
+    top_k(5),
+    running(false),
+    published(0),
+    skipped(0),
+    latency(nullptr)
+{
+}
+
+StatePublisher::~StatePublisher() {
+    stop();
+}
+
+void StatePublisher::setRate(double rate) {
+    this->rate = rate;
+}
+
+void StatePublisher::setTopK(size_t k) {
+    top_k = k;
+}
+
+void StatePublisher::setLatencyTracker(LatencyTracker* latency) {
+    this->latency = latency;
+}
+
+void StatePublisher::start() {
+
+    if (rate <= 0.0 || thread.joinable()) return;
+
+    if (latency) latency->enable(LATENCY_PUBLICATION);
+
+    activations_pub = nh.advertise<UnitActivations>("activations", 1);
+    associations_pub = nh.advertise<UnitAssociations>("associations", 1);
+
+    running = true;
+    thread = std::thread(&StatePublisher::run, this);
+}
+
+void StatePublisher::stop() {
+
+    if (!thread.joinable()) return;
+
+    {
+        lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    stopping.notify_all();
+
+    thread.join();
+}
+
+template<typename M>
+boost::shared_ptr<M> StatePublisher::acquire(vector<boost::shared_ptr<M>>& pool) {
+
+    // only referenced by the pool: not in use anymore
+    for (auto& msg : pool) {
+        if (msg.use_count() == 1) return msg;
+    }
+
+    if (pool.size() < POOL_SIZE) {
+        pool.push_back(boost::shared_ptr<M>(new M));
+        return pool.back();
+    }
+
+    return boost::shared_ptr<M>();
+}
+
+void StatePublisher::refreshNames() {
+    // units are only ever added
+    if (memory.size() != names.size()) names = memory.units_names();
+}
+
+bool StatePublisher::publishActivations() {
+
+    auto msg = acquire(activations_pool);
+    if (!msg) {
+        skipped++;
+        return false;
+    }
+
+    auto activations = memory.activations();
+    size_t size = min(names.size(), (size_t) activations.size());
+
+    msg->header.stamp = ros::Time::now();
+
+    // names are only appended, so only the new ones are copied
+    msg->units.resize(size);
+    for (size_t i = 0; i < size; i++) {
+        if (msg->units[i].empty()) msg->units[i] = names[i];
+    }
+
+    msg->activations.resize(size);
+    for (size_t i = 0; i < size; i++) msg->activations[i] = activations(i);
+
+    activations_pub.publish(msg);
+    published++;
+
+    return true;
+}
+
+void StatePublisher::publishAssociations() {
+
+    auto msg = acquire(associations_pool);
+    if (!msg) {
+        skipped++;
+        return;
+    }
+
+    auto weights = memory.weights();
+    size_t size = min(names.size(), (size_t) weights.rows());
+    size_t k = min(top_k, size > 0 ? size - 1 : 0);
+
+    msg->header.stamp = ros::Time::now();
+    msg->k = top_k;
+
+    msg->units.resize(size);
+    for (size_t i = 0; i < size; i++) {
+        if (msg->units[i].empty()) msg->units[i] = names[i];
+    }
+
+    msg->targets.assign(size * top_k, -1);
+    msg->weights.assign(size * top_k, 0.0f);
+
+    auto strength = [&weights](size_t i, int j) {
+        double w = weights(i, j);
+        return std::isnan(w) ? 0.0 : fabs(w);
+    };
+
+    for (size_t i = 0; i < size; i++) {
+
+        candidates.clear();
+        for (size_t j = 0; j < size; j++) {
+            if (j != i && strength(i, j) > 0.0) candidates.push_back(j);
+        }
+
+        size_t count = min(k, candidates.size());
+
+        partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+                     [&](int a, int b) {return strength(i, a) > strength(i, b);});
+
+        for (size_t c = 0; c < count; c++) {
+            msg->targets[i * top_k + c] = candidates[c];
+            msg->weights[i * top_k + c] = weights(i, candidates[c]);
+        }
+    }
+
+    associations_pub.publish(msg);
+    published++;
+}
+
+void StatePublisher::run() {
+
+    auto period = chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(1.0 / rate));
+    auto next = chrono::steady_clock::now();
+
+    unique_lock<std::mutex> lock(mutex);
+
+    while (running) {
+
+        lock.unlock();
+
+        bool activations = activations_pub.getNumSubscribers() > 0;
+        bool associations = associations_pub.getNumSubscribers() > 0;
+
+        if (activations || associations) refreshNames();
+
+        bool sent = activations && publishActivations();
+        if (associations) publishAssociations();
+
+        if (latency) latency->published(sent);
+
+        lock.lock();
+
+        // does not try to catch up after a slow period
+        next = max(next + period, chrono::steady_clock::now());
+        stopping.wait_until(lock, next, [this]{return !running;});
+    }
+}
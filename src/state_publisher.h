@@ -0,0 +1,134 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef STATE_PUBLISHER_H
+#define STATE_PUBLISHER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <ros/ros.h>
+#include <associative_memory_ros/UnitActivations.h>
+#include <associative_memory_ros/UnitAssociations.h>
+
+#include "AssociativeMemory/memory_network.hpp"
+
+#include "latency.h"
+
+/**
+ * Publishes the state of the network on ROS topics, from a background
+ * thread, at a fixed rate:
+ *  - 'activations' (UnitActivations): activation level of every unit,
+ *  - 'associations' (UnitAssociations): the k strongest associations of
+ *    every unit.
+ *
+ * Messages are published as shared pointers, so that subscribers in the
+ * same process receive them without copy nor serialization. They come from
+ * a small pool and are only refilled once nobody (publisher queue or
+ * subscriber) holds them anymore: in steady state, nothing is allocated.
+ * If every message of a pool is still in use, the topic is skipped for
+ * this period.
+ *
+ * Topics without subscribers are not computed at all.
+ */
+class StatePublisher {
+
+    typedef associative_memory_ros::UnitActivations UnitActivations;
+    typedef associative_memory_ros::UnitAssociations UnitAssociations;
+
+    MemoryNetwork& memory;
+
+    ros::NodeHandle nh;
+    ros::Publisher activations_pub;
+    ros::Publisher associations_pub;
+
+    double rate;
+    size_t top_k;
+
+    std::vector<boost::shared_ptr<UnitActivations>> activations_pool;
+    std::vector<boost::shared_ptr<UnitAssociations>> associations_pool;
+
+    // units names, refreshed when the network grows
+    std::vector<std::string> names;
+
+    // scratch buffer for the top-k selection
+    std::vector<int> candidates;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable stopping;
+    bool running;
+
+    std::atomic<uint64_t> published;
+    std::atomic<uint64_t> skipped;
+
+    LatencyTracker* latency;
+
+    template<typename M>
+    boost::shared_ptr<M> acquire(std::vector<boost::shared_ptr<M>>& pool);
+
+    void refreshNames();
+
+    /** Returns false if the message was skipped
+     */
+    bool publishActivations();
+    void publishAssociations();
+
+    void run();
+
+public:
+    /** Advertises in the namespace of 'nh'
+     */
+    StatePublisher(MemoryNetwork& memory, const ros::NodeHandle& nh = ros::NodeHandle());
+    ~StatePublisher();
+
+    /** Publication rate, in Hz. 0 disables the publication. Must be called
+     * before start().
+     */
+    void setRate(double rate);
+
+    /** Number of associations published per unit. Must be called before
+     * start().
+     */
+    void setTopK(size_t k);
+
+    /** Reports the publications of the activations to 'latency'. Must be
+     * called before start().
+     */
+    void setLatencyTracker(LatencyTracker* latency);
+
+    /** Advertises the topics and starts the publishing thread
+     */
+    void start();
+    void stop();
+
+    uint64_t publishedCount() const {return published;}
+
+    /** Number of messages not published because all the messages of their
+     * pool were still in use
+     */
+    uint64_t skippedCount() const {return skipped;}
+};
+
+#endif // STATE_PUBLISHER_H
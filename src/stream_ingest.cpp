@@ -0,0 +1,306 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "core/logger.h"
+
+#include "memoryview_exceptions.h"
+#include "stream_ingest.h"
+
+using namespace std;
+
+static const size_t BUFFER_SIZE = 1 << 16;
+
+StreamIngest::StreamIngest(MemoryNetwork& memory, const string& path) :
+    AttentionIngest(memory),
+    path(path),
+    fd(-1),
+    server_fd(-1),
+    fifo(false),
+    buffer(BUFFER_SIZE),
+    filled(0),
+    overflow(false),
+    running(false),
+    invalid_lines(0)
+{
+}
+
+StreamIngest::~StreamIngest() {
+    stop();
+    closeSource();
+    if (server_fd >= 0) {
+        close(server_fd);
+        unlink(path.substr(5).c_str());
+    }
+}
+
+void StreamIngest::openSource() {
+
+    if (path == "-") {
+        fd = STDIN_FILENO;
+        return;
+    }
+
+    if (path.compare(0, 5, "unix:") == 0) {
+        string socket_path = path.substr(5);
+
+        sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+
+        if (socket_path.size() >= sizeof(address.sun_path)) {
+            throw MemoryViewException("socket path too long: " + socket_path);
+        }
+        strcpy(address.sun_path, socket_path.c_str());
+
+        unlink(socket_path.c_str());
+
+        server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (server_fd < 0
+            || bind(server_fd, (sockaddr*) &address, sizeof(address)) < 0
+            || listen(server_fd, 1) < 0) {
+            throw MemoryViewException("unable to listen on " + socket_path + ": " + strerror(errno));
+        }
+        return;
+    }
+
+    struct stat info;
+    if (stat(path.c_str(), &info) < 0) {
+        throw MemoryViewException("unable to open " + path + ": " + strerror(errno));
+    }
+
+    fifo = S_ISFIFO(info.st_mode);
+
+    // a FIFO opened for writing as well never reaches its end, even when
+    // its writers come and go
+    fd = open(path.c_str(), fifo ? O_RDWR : O_RDONLY);
+
+    if (fd < 0) {
+        throw MemoryViewException("unable to open " + path + ": " + strerror(errno));
+    }
+}
+
+bool StreamIngest::acceptClient() {
+
+    pollfd request = {server_fd, POLLIN, 0};
+
+    if (poll(&request, 1, (int) (window * 1000)) <= 0) return false;
+
+    fd = accept(server_fd, nullptr, nullptr);
+
+    return fd >= 0;
+}
+
+void StreamIngest::closeSource() {
+
+    if (fd >= 0 && fd != STDIN_FILENO) close(fd);
+    fd = -1;
+
+    // a partial line from a client does not continue in the next one
+    filled = 0;
+    overflow = false;
+}
+
+void StreamIngest::start() {
+
+    running = true;
+    thread = std::thread(&StreamIngest::run, this);
+}
+
+void StreamIngest::stop() {
+
+    running = false;
+
+    if (thread.joinable()) thread.join();
+}
+
+void StreamIngest::parseLine(char* begin, char* end) {
+
+    if (end > begin && end[-1] == '\r') end--;
+    *end = '\0';
+
+    while (begin < end && (*begin == ' ' || *begin == '\t')) begin++;
+
+    if (begin == end || *begin == '#') return;
+
+    // optional send stamp, in microseconds since the epoch
+    uint64_t stamp_us = 0;
+    if (*begin == '@') {
+        // strtoull() would skip blanks and accept a sign
+        if (begin[1] < '0' || begin[1] > '9') {
+            invalid_lines++;
+            return;
+        }
+
+        char* stamp_end;
+        stamp_us = strtoull(begin + 1, &stamp_end, 10);
+
+        if (stamp_end < end && *stamp_end != ' ' && *stamp_end != '\t') {
+            invalid_lines++;
+            return;
+        }
+
+        begin = stamp_end;
+        while (begin < end && (*begin == ' ' || *begin == '\t')) begin++;
+
+        if (begin == end) {
+            invalid_lines++;
+            return;
+        }
+    }
+
+    // the whole line is checked first: a malformed message is skipped,
+    // not partially applied
+    char* first = begin;
+    bool user = true;
+
+    while (begin < end) {
+
+        char* token_end = begin;
+        while (token_end < end && *token_end != ' ' && *token_end != '\t') token_end++;
+
+        if (!user) {
+            char* equal = (char*) memchr(begin, '=', token_end - begin);
+
+            char* number_end = nullptr;
+            float intensity = 0.0f;
+            if (equal && equal != begin) intensity = strtof(equal + 1, &number_end);
+
+            // nan or inf would poison the network state
+            if (!number_end || number_end == equal + 1 || number_end != token_end
+                || !std::isfinite(intensity)) {
+                invalid_lines++;
+                return;
+            }
+        }
+        user = false;
+
+        begin = token_end;
+        while (begin < end && (*begin == ' ' || *begin == '\t')) begin++;
+    }
+
+    received(stamp_us);
+
+    begin = first;
+    user = true;
+
+    while (begin < end) {
+
+        char* token_end = begin;
+        while (token_end < end && *token_end != ' ' && *token_end != '\t') token_end++;
+
+        if (user) {
+            // the unit corresponding to current user
+            target(begin, token_end - begin, 1.0);
+            user = false;
+        }
+        else {
+            char* equal = (char*) memchr(begin, '=', token_end - begin);
+
+            target(begin, equal - begin, strtof(equal + 1, nullptr));
+        }
+
+        begin = token_end;
+        while (begin < end && (*begin == ' ' || *begin == '\t')) begin++;
+    }
+}
+
+bool StreamIngest::readChunk() {
+
+    pollfd request = {fd, POLLIN, 0};
+
+    if (poll(&request, 1, (int) (window * 1000)) <= 0) return true;
+
+    ssize_t count = read(fd, &buffer[filled], buffer.size() - filled);
+
+    if (count < 0) return errno == EINTR || errno == EAGAIN;
+
+    if (count == 0) {
+        // last line, without end of line (there is always room left for
+        // its terminating null character)
+        if (filled > 0 && !overflow) parseLine(&buffer[0], &buffer[filled]);
+        return false;
+    }
+
+    filled += count;
+
+    char* begin = &buffer[0];
+    char* end = begin + filled;
+
+    while (char* newline = (char*) memchr(begin, '\n', end - begin)) {
+        if (overflow) overflow = false;
+        else parseLine(begin, newline);
+
+        begin = newline + 1;
+    }
+
+    if (begin == &buffer[0] && filled == buffer.size()) {
+        // no end of line in the whole buffer
+        if (!overflow) invalid_lines++;
+        overflow = true;
+        filled = 0;
+        return true;
+    }
+
+    // keeps the incomplete last line for the next read
+    filled = end - begin;
+    memmove(&buffer[0], begin, filled);
+
+    return true;
+}
+
+void StreamIngest::run() {
+
+    auto last_drain = chrono::steady_clock::now();
+    auto period = chrono::duration<double>(window);
+
+    while (running) {
+
+        if (fd < 0) {
+            if (server_fd < 0 || !acceptClient()) {
+                // end of a file or of the standard input
+                if (server_fd < 0) this_thread::sleep_for(period);
+                continue;
+            }
+            debugLog("attention stream: client connected\n");
+        }
+
+        if (!readChunk()) {
+            // pending targets of the closed source are still applied
+            drain();
+            closeSource();
+            if (server_fd < 0) debugLog("attention stream: end of %s\n", path.c_str());
+        }
+
+        auto now = chrono::steady_clock::now();
+        if (now - last_drain >= period) {
+            drain();
+            last_drain = now;
+        }
+    }
+}
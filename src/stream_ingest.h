@@ -0,0 +1,99 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef STREAM_INGEST_H
+#define STREAM_INGEST_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "attention_ingest.h"
+
+/**
+ * Receives the attention targets from a byte stream, without ROS. The
+ * source is:
+ *  - "-": the standard input,
+ *  - "unix:PATH": a Unix domain socket, created at PATH; clients are
+ *    served one after the other,
+ *  - any other path: a file or a FIFO. FIFOs are kept open across writers.
+ *
+ * One message per line: the frame_id of the user (activated at 1.0),
+ * followed by its targets, as frame_id=intensity, separated by spaces,
+ * optionally preceded by the time the message was sent, in microseconds
+ * since the epoch:
+ *
+ *     human_1 cup=0.8 table=0.3
+ *     @1476806400000000 human_1 cup=0.8 table=0.3
+ *
+ * Empty lines and lines starting with '#' are ignored. Malformed lines (a
+ * target without '=' or with a non-numeric or non-finite intensity, a stamp
+ * that is not only digits) are skipped as a whole, and counted in
+ * invalidLines().
+ *
+ * The stream is read by its own thread, in large chunks, and the lines are
+ * parsed in place in the read buffer: no copy nor allocation per message.
+ */
+class StreamIngest : public AttentionIngest {
+
+    std::string path;
+
+    int fd;
+    // listening socket, for unix: sources
+    int server_fd;
+    bool fifo;
+
+    std::vector<char> buffer;
+    size_t filled;
+    // the current line did not fit in the buffer: skipped up to its end
+    bool overflow;
+
+    std::thread thread;
+    std::atomic<bool> running;
+
+    std::atomic<uint64_t> invalid_lines;
+
+    bool acceptClient();
+    void closeSource();
+
+    /** Returns false at the end of the stream
+     */
+    bool readChunk();
+    void parseLine(char* begin, char* end);
+
+    void run();
+
+public:
+    StreamIngest(MemoryNetwork& memory, const std::string& path);
+    ~StreamIngest();
+
+    /** Opens the source (throws a MemoryViewException if impossible)
+     */
+    void openSource() override;
+
+    /** Starts the reading thread, on the source opened by openSource()
+     */
+    void start() override;
+    void stop() override;
+
+    /** Lines skipped because they were too long or malformed
+     */
+    uint64_t invalidLines() const {return invalid_lines;}
+};
+
+#endif // STREAM_INGEST_H
@@ -6,3 +6,15 @@ vec4f ACTIVE_COLOUR(DEFAULT_ACTIVE_COLOUR);
 vec4f INHIBITED_COLOUR(DEFAULT_INHIBITED_COLOUR);
 vec4f UNITS_COLOUR(DEFAULT_UNITS_COLOUR);
 vec4f BACKGROUND_COLOUR(DEFAULT_BACKGROUND_COLOUR);
+
+// Colour maps (after the colours they depend on)
+ColourLUT ACTIVATION_COLOURS(INHIBITED_COLOUR, UNITS_COLOUR, ACTIVE_COLOUR);
+ColourLUT WEIGHT_COLOURS(vec4f(0.0, 0.0, 1.0, 0.7), vec4f(0.0, 0.0, 0.0, 0.7), vec4f(1.0, 0.5, 0.0, 0.7));
+
+void updateColourMaps() {
+    ACTIVATION_COLOURS.build(INHIBITED_COLOUR, UNITS_COLOUR, ACTIVE_COLOUR);
+}
+
+// Default level of details thresholds
+float LOD_FAR_NODE_SIZE(DEFAULT_LOD_FAR_NODE_SIZE);
+float LOD_MID_NODE_SIZE(DEFAULT_LOD_MID_NODE_SIZE);
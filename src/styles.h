@@ -20,7 +20,15 @@
 
 #include "core/vectors.h"
 
-enum rendering_mode {NORMAL, SIMPLE, SHADOWS, BLOOM, NAMES, GRAPHVIZ};
+#include "colour_lut.h"
+
+/** Level of detail of the graph rendering, decided from the on-screen size
+ * of the nodes (ie, from the camera distance):
+ *  - LOD_FAR: nodes are points, straight edges, no bloom, shadows or labels
+ *  - LOD_MID: straight edges, no edge labels
+ *  - LOD_NEAR: everything
+ */
+enum level_of_detail {LOD_FAR, LOD_MID, LOD_NEAR};
 
 static const float NODE_SIZE = 15.0;
 static const int BASE_FONT_SIZE = 14;
@@ -43,6 +51,9 @@ static const vec4f DEFAULT_INHIBITED_COLOUR(0., 0.7, 1.0, 1.0); //Blue
 
 static const vec4f DEFAULT_UNITS_COLOUR(0.1, 0.1, 0.1, 1.0);
 
+static const float DEFAULT_LOD_FAR_NODE_SIZE = 4.0; // on-screen size (px) of nodes below which we switch to LOD_FAR
+static const float DEFAULT_LOD_MID_NODE_SIZE = 8.0; // on-screen size (px) of nodes below which we switch to LOD_MID
+
 //static const vec4f DEFAULT_BACKGROUND_COLOUR(0.0, 0.0, 0.0);
 static const vec4f DEFAULT_BACKGROUND_COLOUR(1.0, 1.0, 1.0);
 
@@ -55,5 +66,16 @@ extern vec4f INHIBITED_COLOUR;
 extern vec4f UNITS_COLOUR;
 extern vec4f BACKGROUND_COLOUR;
 
+// Colour maps of the activations (INHIBITED_COLOUR -> UNITS_COLOUR ->
+// ACTIVE_COLOUR) and of the weights. Call updateColourMaps() after
+// changing the colours.
+extern ColourLUT ACTIVATION_COLOURS;
+extern ColourLUT WEIGHT_COLOURS;
+void updateColourMaps();
+
+// Level of details thresholds (set to 0 to always render at full details)
+extern float LOD_FAR_NODE_SIZE;
+extern float LOD_MID_NODE_SIZE;
+
 
 #endif // STYLES_H
@@ -0,0 +1,44 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "unit_index.h"
+
+using namespace std;
+
+size_t UnitIndex::intern(MemoryNetwork& memory, const string& name) {
+
+    auto id = ids.find(name);
+    if (id != ids.end()) return id->second;
+
+    // units added since the last synchronization
+    if (memory.size() != known_units) {
+        auto names = memory.units_names();
+
+        for (size_t i = known_units; i < names.size(); i++) {
+            ids.emplace(names[i], i);
+        }
+        known_units = names.size();
+
+        id = ids.find(name);
+        if (id != ids.end()) return id->second;
+    }
+
+    size_t unit = memory.add_unit(name);
+    ids.emplace(name, unit);
+
+    return unit;
+}
@@ -0,0 +1,76 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef UNIT_INDEX_H
+#define UNIT_INDEX_H
+
+#include <string>
+#include <unordered_map>
+
+#include "AssociativeMemory/memory_network.hpp"
+
+/**
+ * Interning table of the unit names of a network: maps a name to the
+ * index of its unit, so that units are activated by index, and each name is
+ * hashed once per message instead of once per network call.
+ *
+ * Units are never removed or re-ordered, so entries stay valid: the table
+ * only re-synchronizes (with the units added by someone else) when a name
+ * is not found and the size of the network changed.
+ */
+class UnitIndex {
+
+    // FNV-1a
+    struct Hash {
+        size_t operator()(const std::string& str) const {
+            size_t hash = 14695981039346656037ULL;
+            for (unsigned char c : str) {
+                hash ^= c;
+                hash *= 1099511628211ULL;
+            }
+            return hash;
+        }
+    };
+
+    std::unordered_map<std::string, size_t, Hash> ids;
+
+    // number of units of the network at the last synchronization
+    size_t known_units;
+
+    // lookup key, for names that are not strings
+    std::string key;
+
+public:
+    UnitIndex() : known_units(0) {}
+
+    void reserve(size_t units) {ids.reserve(units);}
+
+    /** Returns the index of the unit 'name', adding it to the network if
+     * needed.
+     */
+    size_t intern(MemoryNetwork& memory, const std::string& name);
+
+    /** Same, for a name that is not null-terminated. Does not allocate
+     * once the key buffer is large enough.
+     */
+    size_t intern(MemoryNetwork& memory, const char* name, size_t length) {
+        key.assign(name, length);
+        return intern(memory, key);
+    }
+};
+
+#endif // UNIT_INDEX_H
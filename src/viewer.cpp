@@ -0,0 +1,105 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <memory>
+
+#include "macros.h"
+
+#include "core/sdlapp.h"
+#include "core/display.h"
+
+#include "memoryview.h"
+#include "viewer.h"
+
+using namespace std;
+
+void runViewer(MemoryCore& core, const Json::Value& config, const ViewerOptions& options) {
+
+    SDLAppInit("Memory View", "memory-view");
+
+#ifndef TEXT_ONLY
+
+    // this causes corruption on some video drivers
+    if(options.multisample) {
+        display.multiSample(4);
+    }
+
+    //enable vsync (not when exporting: frames are rendered as fast as possible)
+    display.enableVsync(options.output_file.empty());
+
+#ifdef SDLAPP_SHADER_SUPPORT
+    display.enableShaders(true);
+#endif
+
+    try {
+
+        display.init("Memory View", options.width, options.height, options.fullscreen);
+
+    } catch(SDLInitException& exception) {
+
+        throw MemoryViewException(string("SDL initialization failed ") + exception.what());
+    }
+
+    if(options.multisample) glEnable(GL_MULTISAMPLE_ARB);
+
+#endif
+
+    // finishes the export when destroyed, even if the view throws
+    unique_ptr<FrameExporter> exporter;
+
+    try {
+        MemoryView memoryview(config, core);
+
+        if (options.capacity) memoryview.reserveUnits(options.capacity);
+
+        if (!options.output_file.empty()) {
+            if (options.output_format == "y4m")
+                exporter.reset(new Y4MExporter(options.output_file, options.video_framerate));
+            else
+                exporter.reset(new PPMExporter(options.output_file, options.video_framerate));
+
+            memoryview.setFrameExporter(exporter.get());
+        }
+
+        memoryview.run();
+
+    } catch(ResourceException& exception) {
+
+        throw MemoryViewException(string("failed to load resource ") + exception.what());
+
+    } catch(FrameExporterException& exception) {
+
+        throw MemoryViewException(string("failed to open output stream ") + exception.what());
+
+    }
+
+    // before the GL context goes away
+    exporter.reset();
+
+#ifndef TEXT_ONLY
+
+    //free resources
+    display.quit();
+
+#endif
+}
+
+void closeViewer() {
+    SDL_Event event;
+    event.type = SDL_QUIT;
+    SDL_PushEvent(&event);
+}
@@ -0,0 +1,52 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef VIEWER_H
+#define VIEWER_H
+
+#include <string>
+
+#include <json/json.h>
+
+#include "memory_core.h"
+
+struct ViewerOptions {
+    int width = 1024;
+    int height = 768;
+    bool fullscreen = false;
+    bool multisample = false;
+
+    // if not empty, frames are rendered at a fixed timestep and written to
+    // this file ('-' for stdout)
+    std::string output_file;
+    std::string output_format = "ppm";
+    int video_framerate = 60;
+
+    // expected number of units (0: unknown)
+    size_t capacity = 0;
+};
+
+/** Opens the window and runs a MemoryView of 'core' until it is closed.
+ * Throws a MemoryViewException on error.
+ */
+void runViewer(MemoryCore& core, const Json::Value& config, const ViewerOptions& options);
+
+/** Asks a viewer running in another thread to close its window
+ */
+void closeViewer();
+
+#endif // VIEWER_H
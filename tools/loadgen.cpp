@@ -0,0 +1,225 @@
+/*
+    Copyright (c) 2016 Séverin Lemaignan (severin.lemaignan@plymouth.ac.uk)
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version
+    3 of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Synthetic load for the attention ingestion: writes attention messages in
+ * the stream format of StreamIngest (see --input), with a send stamp, to a
+ * file, a FIFO, a Unix socket ('unix:PATH') or stdout ('-').
+ *
+ * Each message comes from one of --users users, and targets
+ * --targets-per-message units drawn with a Zipfian popularity (the n-th
+ * most popular unit is drawn with a probability proportional to
+ * 1 / n^zipf). New units appear at --new-units per second, as the least
+ * popular ones. Every --burst-period seconds, the rate is multiplied by
+ * --burst-factor for --burst-duration seconds.
+ *
+ * Run the viewer with --input and --latency-report to get the latencies.
+ */
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace std::chrono;
+namespace po = boost::program_options;
+
+// messages due at the same time are written together, at most every TICK
+static const auto TICK = milliseconds(1);
+
+class Zipf {
+
+    double exponent;
+    // cumulated (unnormalized) probabilities, by rank
+    vector<double> cumulated;
+
+public:
+    Zipf(double exponent) : exponent(exponent) {}
+
+    void add() {
+        double p = 1.0 / pow(cumulated.size() + 1, exponent);
+        cumulated.push_back(cumulated.empty() ? p : cumulated.back() + p);
+    }
+
+    size_t size() const {return cumulated.size();}
+
+    template<typename G>
+    size_t operator()(G& generator) {
+        uniform_real_distribution<double> uniform(0.0, cumulated.back());
+        return upper_bound(cumulated.begin(), cumulated.end(), uniform(generator)) - cumulated.begin();
+    }
+};
+
+static int openOutput(const string& path) {
+
+    if (path == "-") return STDOUT_FILENO;
+
+    if (path.compare(0, 5, "unix:") == 0) {
+        string socket_path = path.substr(5);
+
+        sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, (sockaddr*) &address, sizeof(address)) == 0) return fd;
+
+        cerr << "Unable to connect to " << socket_path << ": " << strerror(errno) << endl;
+        return -1;
+    }
+
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) cerr << "Unable to open " << path << ": " << strerror(errno) << endl;
+
+    return fd;
+}
+
+static bool writeAll(int fd, const string& data) {
+
+    size_t written = 0;
+
+    while (written < data.size()) {
+        ssize_t count = write(fd, data.data() + written, data.size() - written);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        written += count;
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+            ("help,h", "produce help message")
+            ("output,o", po::value<string>()->default_value("-"), "file, FIFO, Unix socket ('unix:PATH') or stdout ('-')")
+            ("duration,d", po::value<double>()->default_value(60.0), "duration (s)")
+            ("rate,r", po::value<double>()->default_value(100.0), "messages per second, outside bursts")
+            ("users,u", po::value<int>()->default_value(100), "number of users")
+            ("targets-per-message,t", po::value<int>()->default_value(10), "targets per message")
+            ("units", po::value<int>()->default_value(200), "initial number of units")
+            ("zipf", po::value<double>()->default_value(1.0), "exponent of the popularity of the units")
+            ("new-units", po::value<double>()->default_value(1.0), "new units per second")
+            ("burst-period", po::value<double>()->default_value(0.0), "time between bursts (s, 0: no bursts)")
+            ("burst-duration", po::value<double>()->default_value(1.0), "duration of bursts (s)")
+            ("burst-factor", po::value<double>()->default_value(10.0), "rate multiplier during bursts")
+            ("seed", po::value<unsigned int>()->default_value(0), "random seed")
+            ;
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help")) {
+        cout << "memory-loadgen -- synthetic attention targets for memory-view\n\n" << desc << "\n";
+        return 1;
+    }
+
+    double run_time = vm["duration"].as<double>();
+    double rate = vm["rate"].as<double>();
+    int users = vm["users"].as<int>();
+    int targets_per_message = vm["targets-per-message"].as<int>();
+    double new_units = vm["new-units"].as<double>();
+    double burst_period = vm["burst-period"].as<double>();
+    double burst_duration = vm["burst-duration"].as<double>();
+    double burst_factor = vm["burst-factor"].as<double>();
+
+    if (rate <= 0 || users <= 0 || targets_per_message < 0 || vm["units"].as<int>() <= 0
+        || new_units < 0 || burst_factor <= 0 || burst_duration < 0) {
+        cerr << "Invalid parameters" << endl;
+        return 1;
+    }
+
+    int fd = openOutput(vm["output"].as<string>());
+    if (fd < 0) return 1;
+
+    mt19937 generator(vm["seed"].as<unsigned int>());
+    uniform_int_distribution<int> user(0, users - 1);
+    uniform_real_distribution<float> intensity(0.1f, 1.0f);
+
+    Zipf popularity(vm["zipf"].as<double>());
+    for (int i = 0; i < vm["units"].as<int>(); i++) popularity.add();
+
+    string pending;
+    uint64_t messages = 0;
+
+    auto start = steady_clock::now();
+
+    // time (since start) of the next message, and of the next new unit
+    double next_message = 0.0;
+    double next_unit = new_units > 0 ? 1.0 / new_units : run_time;
+
+    while (next_message < run_time) {
+
+        double now = duration_cast<duration<double>>(steady_clock::now() - start).count();
+
+        while (next_message <= now && next_message < run_time) {
+
+            while (next_unit <= next_message) {
+                popularity.add();
+                next_unit += 1.0 / new_units;
+            }
+
+            uint64_t stamp = duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+
+            pending += "@" + to_string(stamp) + " user_" + to_string(user(generator));
+
+            for (int t = 0; t < targets_per_message; t++) {
+                pending += " unit_" + to_string(popularity(generator)) + "=" + to_string(intensity(generator));
+            }
+            pending += "\n";
+
+            messages++;
+
+            bool burst = burst_period > 0 && fmod(next_message, burst_period) >= burst_period - burst_duration;
+            next_message += 1.0 / (burst ? rate * burst_factor : rate);
+        }
+
+        if (!pending.empty()) {
+            if (!writeAll(fd, pending)) {
+                cerr << "Write error: " << strerror(errno) << endl;
+                return 1;
+            }
+            pending.clear();
+        }
+
+        this_thread::sleep_for(TICK);
+    }
+
+    cerr << messages << " messages sent, " << popularity.size() << " units" << endl;
+
+    if (fd != STDOUT_FILENO) close(fd);
+
+    return 0;
+}